@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ProfiledMutex.h"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Learned hall-call rates per floor and time of day. The day is split into
+// SLOTS_PER_DAY slots of local time. Calls are counted per floor in the
+// current slot; when the slot ends its counts are folded into that slot's
+// exponentially weighted average, so each slot learns from the same time on
+// earlier days (the lobby at 8:45, the cafeteria floor at noon).
+class ArrivalStats {
+public:
+    static constexpr int SLOT_MINUTES = 15;
+    static constexpr int SLOTS_PER_DAY = 24 * 60 / SLOT_MINUTES;
+    
+    // smoothing is the weight of the newest day in each slot's average
+    explicit ArrivalStats(int floors, double smoothing = 0.3);
+    
+    void record(int floor, std::chrono::system_clock::time_point when);
+    
+    // Expected calls per slot at each floor around when, indexed by floor
+    // (index 0 unused). The slot's history (or, for a slot not seen before,
+    // the last completed slot) covers the rest of the slot, and the calls
+    // already counted in it are added on top.
+    void getRates(std::chrono::system_clock::time_point when, std::vector<double>& out);
+    
+    uint64_t getRecordedCount() const;
+
+private:
+    int numFloors;
+    double smoothing;
+    
+    mutable ProfiledMutex statsMutex{"ArrivalStats::statsMutex"};
+    // SLOTS_PER_DAY rows of numFloors + 1 rates
+    std::vector<double> history;
+    std::vector<bool> slotSeen;
+    std::vector<double> lastSlot;
+    std::vector<double> live;
+    // Slots since the epoch in local time, -1 before the first call
+    int64_t currentSlot;
+    uint64_t recorded;
+    
+    // Slot index since the epoch in local time, and the fraction of it elapsed
+    static int64_t localSlot(std::chrono::system_clock::time_point when, double* elapsed);
+    // Fold every slot that ended before slot into the history; caller holds statsMutex
+    void advanceTo(int64_t slot);
+};
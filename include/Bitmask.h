@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// Fixed-size bitset whose size is chosen at runtime. Used for the floors a car
+// serves and, per floor, the cars that serve it.
+class Bitmask {
+private:
+    std::vector<uint64_t> words;
+    size_t bits = 0;
+    
+public:
+    Bitmask() = default;
+    explicit Bitmask(size_t numBits, bool value = false);
+    
+    size_t size() const { return bits; }
+    void resize(size_t numBits);
+    
+    void set(size_t bit) { words[bit / 64] |= uint64_t(1) << (bit % 64); }
+    void reset(size_t bit) { words[bit / 64] &= ~(uint64_t(1) << (bit % 64)); }
+    bool test(size_t bit) const {
+        return bit < bits && (words[bit / 64] >> (bit % 64)) & 1;
+    }
+    
+    bool any() const;
+    size_t count() const;
+    // Index of the lowest set bit, or size() if none is set
+    size_t first() const;
+    
+    bool operator==(const Bitmask& other) const { return bits == other.bits && words == other.words; }
+    bool operator!=(const Bitmask& other) const { return !(*this == other); }
+    
+    // Call fn(bit) for every bit set in both masks, lowest first, without
+    // materialising the intersection
+    template <typename Fn>
+    friend void forEachCommonBit(const Bitmask& a, const Bitmask& b, Fn&& fn) {
+        size_t numWords = std::min(a.words.size(), b.words.size());
+        for (size_t i = 0; i < numWords; i++) {
+            uint64_t word = a.words[i] & b.words[i];
+            while (word != 0) {
+                fn(i * 64 + static_cast<size_t>(__builtin_ctzll(word)));
+                word &= word - 1;
+            }
+        }
+    }
+};
+
+// Parse a list such as "1,20-40" into a mask of size maxBit + 1. Returns
+// std::nullopt for malformed entries or bits outside [minBit, maxBit].
+std::optional<Bitmask> parseBitList(std::string_view list, size_t minBit, size_t maxBit);
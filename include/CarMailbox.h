@@ -0,0 +1,51 @@
+#pragma once
+
+#include "ProfiledMutex.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+
+// Commands for one car's thread. Any thread may post; only the car takes
+// them. Posting ORs the command into a single word, and the car parks on
+// that word itself (a futex on Linux), so a command posted between the car
+// checking for work and going to sleep is never lost, and only a post that
+// finds the car parked pays for a wake-up.
+class CarMailbox {
+public:
+    enum Command : uint32_t {
+        WORK = 1u << 0,        // A trip was queued
+        EMERGENCY = 1u << 1,   // Stop where you are
+        RELEASE = 1u << 2,     // Emergency cleared
+        SHUTDOWN = 1u << 3,    // Leave the processing loop
+        PARK = 1u << 4         // Reposition while idle
+    };
+    
+    CarMailbox();
+    
+    void post(uint32_t command);
+    
+    // Posted commands since the last take, or 0; never blocks
+    uint32_t take();
+    // Park until a command is posted or the deadline passes. Returns and
+    // clears the posted commands; 0 means the deadline passed.
+    uint32_t waitUntil(std::chrono::steady_clock::time_point deadline);
+    uint32_t wait();
+    
+    // Times the car actually went to sleep, for tests and diagnostics
+    uint64_t getParkCount() const;
+
+private:
+    std::atomic<uint32_t> commands;
+    std::atomic<bool> parked;
+    std::atomic<uint64_t> parkCount;
+
+#ifndef __linux__
+    ProfiledMutex parkMutex{"CarMailbox::parkMutex"};
+    std::condition_variable_any parkCV;
+#endif
+    
+    // Sleep while commands is 0, until woken or the deadline (or spuriously)
+    void park(const std::chrono::steady_clock::time_point* deadline);
+    void unpark();
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "EventSink.h"
+#include "LogEventType.h"
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// The statements DatabaseLogger runs against PostgreSQL. Only
+// src/PostgresConnection.cpp includes libpqxx; the test build links an
+// offline stand-in from tests/ instead, so the logger's buffering, spill and
+// reconnect logic is tested without a server.
+class DatabaseConnection {
+public:
+    // Thrown when the server has gone away; any other failure throws a
+    // std::exception and leaves the connection usable
+    class Broken : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+    
+    struct LogEntry {
+        LogEventType eventType;
+        int elevatorId;
+        int fromFloor;
+        int toFloor;
+        std::chrono::system_clock::time_point time;
+    };
+    
+    virtual ~DatabaseConnection() = default;
+    
+    virtual bool isOpen() const = 0;
+    // "database as user", for the connection message
+    virtual std::string describe() const = 0;
+    
+    // Create the elevators and elevator_logs tables if they don't exist
+    virtual void createSchema() = 0;
+    // One row stamped by the server, or a batch in one transaction keeping
+    // each entry's own time
+    virtual void insertLog(LogEventType eventType, int elevatorId, int fromFloor, int toFloor) = 0;
+    virtual void insertLogs(const std::deque<LogEntry>& entries) = 0;
+    virtual void upsertElevator(int elevatorId, int currentFloor, int destFloor, int direction, int status) = 0;
+    
+    virtual std::vector<EventSink::ElevatorState> selectElevators() = 0;
+    // Rows older than `before` (max() for all), newest first
+    virtual std::vector<EventSink::LogRow> selectRecentLogs(int limit, std::chrono::system_clock::time_point before) = 0;
+};
+
+// Open a connection with libpq options; throws if the server can't be reached
+std::unique_ptr<DatabaseConnection> openDatabaseConnection(const std::string& options);
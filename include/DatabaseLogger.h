@@ -1,62 +1,100 @@
 #pragma once
 
-#include "Elevator.h"
+#include "DatabaseConnection.h"
+#include "EventSink.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <string>
 #include <mutex>
+#include <thread>
 #include <vector>
 #include <memory>
 
-// Only include PostgreSQL in non-test builds
-#ifndef ELEVATOR_TESTING
-#include <pqxx/pqxx>
-#endif
-
-enum class LogEventType {
-    CALL_REQUEST,
-    ELEVATOR_DISPATCHED,
-    ELEVATOR_ARRIVED,
-    DOOR_OPENED,
-    DOOR_CLOSED,
-    EMERGENCY_STOP,
-    EMERGENCY_RELEASED,
-    SYSTEM_STARTED,
-    SYSTEM_STOPPED,
-    SYNC_EVENT
-};
-
-class DatabaseLogger {
+// PostgreSQL event sink, shared by every instance for logs and car state
+class DatabaseLogger : public EventSink {
 private:
     std::string connectionString;
-    std::mutex dbMutex;
-    bool connected;
+    ProfiledMutex dbMutex{"DatabaseLogger::dbMutex"};
+    std::atomic<bool> connected;
+    EventCounters counters;
+    
+    // Background connection with retry, so startup never waits on PostgreSQL
+    // and a dropped connection is re-established
+    std::thread connectThread;
+    std::atomic<bool> connecting;
+    ProfiledMutex connectMutex{"DatabaseLogger::connectMutex"};
+    std::condition_variable_any connectCV;
+    
+    // Events logged while the database is unreachable, replayed in order once
+    // it is back. The memory buffer overflows into spillPath when one is set.
+    using BufferedEvent = DatabaseConnection::LogEntry;
+    std::deque<BufferedEvent> bufferedEvents;
+    mutable ProfiledMutex bufferMutex{"DatabaseLogger::bufferMutex"};
+    bool hasConnected;
+    std::string spillPath;
+    size_t spillFileEvents;
+    
+    void connectionLoop();
+    // Called when an operation finds the connection broken
+    void connectionLost();
+    bool bufferEvent(LogEventType eventType, int elevatorId, int fromFloor, int toFloor);
+    // Move the memory buffer to the end of the spill file; bufferMutex held
+    bool spillToDisk();
+    std::deque<BufferedEvent> readSpillFile();
+    // Write the spill file and memory buffer, then go live; dbMutex held
+    bool replayBufferedEvents();
+    bool writeEvents(const std::deque<BufferedEvent>& events);
     
-    #ifndef ELEVATOR_TESTING
-    std::unique_ptr<pqxx::connection> conn;
+    // Time spent executing and committing write transactions
+    LatencyHistogram writeLatency;
     
-    // Initialize database tables if they don't exist
-    void initializeDatabase();
+    std::unique_ptr<DatabaseConnection> conn;
     
     // Get a formatted timestamp for logging
     std::string getCurrentTimestamp() const;
-    #endif
     
 public:
     DatabaseLogger(const std::string& connString = "dbname=elevator_db user=elevator_user password=secret host=localhost");
     DatabaseLogger(bool connectToDb); // Constructor for testing/mocking
-    ~DatabaseLogger();
+    ~DatabaseLogger() override;
+    
+    // Beyond this many events the memory buffer spills to disk, or drops its
+    // oldest event when there is no spill file
+    static constexpr size_t MAX_BUFFERED_EVENTS = 10000;
+    static constexpr size_t MAX_SPILLED_EVENTS = 1000000;
+    static constexpr std::chrono::milliseconds INITIAL_RETRY_DELAY{250};
+    static constexpr std::chrono::milliseconds MAX_RETRY_DELAY{30000};
     
     bool connect();
+    // Connect and create the schema on a background thread, retrying with
+    // exponential backoff, and reconnect whenever the connection drops,
+    // until disconnect() is called
+    void connectAsync();
     void disconnect();
-    bool isConnected() const;
+    bool isConnected() const override;
+    
+    // EventSink lifecycle: connectAsync() and disconnect()
+    void open() override;
+    void close() override;
+    
+    // Overflow file for buffered events, kept across restarts; call before connecting
+    void setSpillFile(const std::string& path);
+    
+    size_t getBufferedEventCount() const override;
+    EventCounters getEventCounters() const override;
     
     // Logging methods
-    void logEvent(LogEventType eventType, int elevatorId, int fromFloor, int toFloor);
-    void logSystemEvent(LogEventType eventType);
+    void logEvent(LogEventType eventType, int elevatorId, int fromFloor, int toFloor) override;
     
     // Synchronization methods
-    void syncElevatorState(int elevatorId, int currentFloor, int destFloor, int direction, int status);
-    std::vector<std::tuple<int, int, int, Direction, ElevatorStatus>> getElevatorStates();
+    void syncElevatorState(int elevatorId, int currentFloor, int destFloor, int direction, int status) override;
+    std::vector<ElevatorState> getElevatorStates() override;
     
     // Retrieve logs
-    std::vector<std::tuple<std::string, std::string, int, int, int>> getRecentLogs(int limit = 10);
+    std::vector<LogRow> getRecentLogs(int limit = 10, std::chrono::system_clock::time_point before = std::chrono::system_clock::time_point::max()) override;
+    
+    LatencyHistogram::Snapshot getWriteLatency() const override;
 };
\ No newline at end of file
@@ -0,0 +1,10 @@
+#pragma once
+
+// How the controller assigns requests that already know their destination
+enum class DispatchMode {
+    // Each request is scored on its own against every eligible car
+    CONVENTIONAL,
+    // Passengers enter origin and destination at a lobby keypad; requests
+    // sharing both join a car already queued for that trip while it has room
+    DESTINATION
+};
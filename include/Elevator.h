@@ -1,13 +1,22 @@
 #pragma once
 
+#include "Bitmask.h"
+#include "CarMailbox.h"
+#include "Kinematics.h"
+#include "ProfiledMutex.h"
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <mutex>
-#include <condition_variable>
-#include <queue>
+#include <deque>
+#include <memory>
+#include <optional>
 #include <vector>
 #include <string>
 #include <thread>
 
+class EventBus;
+
 enum class Direction {
     IDLE,
     UP,
@@ -25,13 +34,32 @@ struct Request {
     int fromFloor;
     int toFloor;
     Direction direction;
+    // Passengers travelling from fromFloor to toFloor. Call requests (toFloor
+    // 0) only summon a car and carry none.
+    int passengers;
     std::chrono::system_clock::time_point timestamp;
     
-    Request(int from, int to, Direction dir) 
-        : fromFloor(from), toFloor(to), direction(dir), 
+    Request(int from, int to, Direction dir, int passengerCount = 1) 
+        : fromFloor(from), toFloor(to), direction(dir),
+          passengers(to != 0 ? passengerCount : 0),
           timestamp(std::chrono::system_clock::now()) {}
 };
 
+// A queued trip and how long, in simulated time, until its car reaches the
+// pickup floor
+struct QueuedCall {
+    Request request;
+    std::chrono::milliseconds pickupEta;
+};
+
+struct Passenger {
+    uint64_t id;
+    int originFloor;
+    int destinationFloor;
+    std::chrono::system_clock::time_point arrivalTime;  // when the request was made
+    std::chrono::system_clock::time_point boardTime;
+};
+
 class Elevator {
 private:
     int id;
@@ -39,26 +67,103 @@ private:
     std::atomic<int> destinationFloor;
     std::atomic<Direction> direction;
     std::atomic<ElevatorStatus> status;
-    std::mutex requestMutex;
-    std::condition_variable requestCV;
-    std::queue<Request> requests;
+    mutable ProfiledMutex requestMutex{"Elevator::requestMutex"};
+    // Wakes the car's thread for new trips, emergencies, release and stop.
+    // The flags and the queue are the state; the mailbox only says to look.
+    CarMailbox mailbox;
+    // A queued trip and the simulated time planned for it, from the end of
+    // the trip before it to closing the doors at its destination
+    struct QueuedTrip {
+        Request request;
+        std::chrono::milliseconds plannedTime;
+    };
+    // Deque rather than queue so destination dispatch can add passengers to
+    // a trip that has not started yet
+    std::deque<QueuedTrip> requests;
+    // Trip being served. Until the doors close at its pickup floor,
+    // destination dispatch may still add passengers to it.
+    Request activeTrip{0, 0, Direction::IDLE};
+    bool activeTripJoinable = false;
+    // Set once the active trip's passengers are on board
+    bool activeTripBoarded = false;
+    // How long doors stay open at a pickup floor for late keypad entries
+    std::atomic<int> boardingHoldMs{0};
+    // Floor to wait at once the queue is empty, 0 for none. Set by park() and
+    // cleared when a trip is taken, both under requestMutex.
+    int parkingFloor = 0;
+    
+    // ETA model, kept up to date on every queue change and guarded by
+    // requestMutex: committed work ends at committedEndFloor once the active
+    // trip (due at activeTripDue) and every queued trip have been served
+    std::chrono::steady_clock::time_point activeTripDue;
+    std::chrono::milliseconds queuedWork{0};
+    int committedEndFloor;
+    bool tripInProgress = false;
     std::atomic<bool> emergencyStop;
     std::atomic<bool> running;
     
     int numFloors;
+    // Floors this car stops at, indexed by floor number (bit 0 unused)
+    Bitmask servedFloors;
+    
+    // Counters written only by this car's thread and read on metrics scrape
+    std::atomic<uint64_t> tripsCompleted;
+    std::atomic<uint64_t> floorsTravelled;
+    std::atomic<uint64_t> doorCycles;
+    std::atomic<uint64_t> passengersDelivered;
+    
+    // Passenger load. Only this car's thread boards and alights passengers;
+    // queuedPassengers counts passengers in requests not yet picked up.
+    int capacity;
+    std::vector<Passenger> onboard;
+    std::atomic<int> load;
+    std::atomic<int> queuedPassengers;
+    // (time, passengers) per drop-off within HANDLING_CAPACITY_WINDOW,
+    // guarded by requestMutex
+    std::deque<std::pair<std::chrono::steady_clock::time_point, int>> recentDeliveries;
     
-    // Time it takes to move between floors (in milliseconds)
-    const int FLOOR_TRAVEL_TIME_MS = 1000;
-    // Time it takes for doors to open/close (in milliseconds)
-    const int DOOR_OPERATION_TIME_MS = 1000;
+    // Travel times in simulated time, usually shared by every car in a
+    // controller, and how fast simulated time runs against the wall clock
+    std::shared_ptr<const TravelTimeTable> travelTimes;
+    DoorTiming doorTiming;
+    double timeScale;
+    
+    // Departures, floors passed, arrivals and door cycles go here if set
+    EventBus* eventBus = nullptr;
     
     // Thread for processing requests
     std::thread processingThread;
     
     void processRequests();
-    void moveToFloor(int floor);
+    // Travel to floor, then cycle the doors for passengersExchanged people
+    void moveToFloor(int floor, int passengersExchanged);
+    // Run to floor one leg at a time; false if cut short. With yieldToTrips
+    // the run also ends at the next floor once a trip is queued.
+    bool runToFloor(int floor, bool yieldToTrips);
+    // Parking run: doors stay shut and any queued trip takes over
+    void reposition(int floor);
+    bool hasQueuedTrips() const;
+    // Wait for a leg of a run, a door dwell or a boarding hold; false if an
+    // emergency stop or shutdown cut it short
+    bool pauseUntil(std::chrono::steady_clock::time_point deadline);
+    std::chrono::nanoseconds toWallTime(std::chrono::milliseconds simulated) const;
+    // Simulated time to serve request starting from startFloor
+    std::chrono::milliseconds plannedTripTime(int startFloor, const Request& request) const;
+    // Append to the queue and the ETA model; caller holds requestMutex
+    void enqueueTrip(const Request& request);
+    // Recompute every queued trip's plan after one leaves the middle of the
+    // queue; caller holds requestMutex
+    void replanQueue();
+    // Simulated time left on the active trip; caller holds requestMutex
+    std::chrono::milliseconds activeTripRemaining() const;
+    void boardPassengers(const Request& request);
+    void alightPassengers();
     
 public:
+    static constexpr int DEFAULT_CAPACITY = 8;
+    // Handling capacity is conventionally quoted as passengers per 5 minutes
+    static constexpr std::chrono::minutes HANDLING_CAPACITY_WINDOW{5};
+    
     Elevator(int elevatorId, int startFloor = 1, int floors = 10);
     ~Elevator();
     
@@ -68,6 +173,52 @@ public:
     void emergencyStopRelease();
     bool addRequest(const Request& request);
     
+    // Add the request's passengers to a queued, not yet started trip with the
+    // same origin and destination if the combined group fits in the car
+    bool joinQueuedRequest(const Request& request);
+    
+    // Trips queued but not started, in service order, with the car's ETA to
+    // each pickup floor
+    void getQueuedCalls(std::vector<QueuedCall>& out) const;
+    // Take back a queued trip (matched by floors and call time) so another
+    // car can serve it; std::nullopt if this car has already started it
+    std::optional<Request> withdrawQueuedCall(const Request& call);
+    void setBoardingHold(std::chrono::milliseconds hold);
+    
+    // Send an idle car to wait at floor. False if the car has work, is
+    // stopped or does not serve floor.
+    bool park(int floor);
+    
+    // Restrict the car to a zone, express route or sky lobby. Call before
+    // start(); a car parked on a floor it no longer serves moves its start
+    // position to its lowest served floor.
+    bool setServedFloors(const Bitmask& floors);
+    const Bitmask& getServedFloors() const;
+    bool servesFloor(int floor) const;
+    
+    // Maximum passengers on board; call before start()
+    bool setCapacity(int passengers);
+    int getCapacity() const;
+    int getLoad() const;
+    // Room left once every queued passenger has boarded (may be negative)
+    int getAvailableCapacity() const;
+    
+    // Replace the motion model; table must cover this car's floors. Call
+    // before start().
+    bool setKinematics(const KinematicConfig& config, std::shared_ptr<const TravelTimeTable> table);
+    const TravelTimeTable& getTravelTimes() const;
+    const DoorTiming& getDoorTiming() const;
+    
+    // Publish movement and door events to bus; call before start()
+    void setEventBus(EventBus* bus);
+    
+    // Outstanding work in service order: the active trip (from the car's
+    // current floor if its passengers have boarded) and then the queue
+    std::vector<Request> getOutstandingRequests() const;
+    // Resume from a checkpoint: move to floor, restore the emergency flag and
+    // queue requests, which must only touch served floors. Call before start().
+    bool restore(int floor, bool emergency, const std::vector<Request>& outstanding);
+    
     // Getters
     int getId() const;
     int getCurrentFloor() const;
@@ -77,6 +228,19 @@ public:
     bool isIdle() const;
     bool hasEmergencyStop() const;
     
+    // Metrics
+    uint64_t getTripsCompleted() const;
+    uint64_t getFloorsTravelled() const;
+    uint64_t getDoorCycles() const;
+    size_t getQueueDepth() const;
+    uint64_t getPassengersDelivered() const;
+    // Passengers dropped off within HANDLING_CAPACITY_WINDOW
+    int getRecentDeliveries() const;
+    
     // For calculating distance to a floor
     int calculateDistance(int floor) const;
+    // Simulated time until the car could stop at floor for a new request,
+    // after serving every trip already committed to it. Cars serve their
+    // queue in order, so this is the committed work plus one table lookup.
+    std::chrono::milliseconds estimateTravelTime(int floor) const;
 };
\ No newline at end of file
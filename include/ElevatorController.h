@@ -1,7 +1,13 @@
 #pragma once
 
+#include "ArrivalStats.h"
 #include "Elevator.h"
-#include "DatabaseLogger.h"
+#include "DispatchMode.h"
+#include "EventBus.h"
+#include "EventSink.h"
+#include "Metrics.h"
+#include "ProfiledMutex.h"
+#include "Snapshot.h"
 #include <vector>
 #include <memory>
 #include <thread>
@@ -9,46 +15,251 @@
 #include <condition_variable>
 #include <queue>
 #include <atomic>
+#include <tuple>
+#include <optional>
+#include <string>
+
+// Snapshot of one car: id, current floor, destination floor, direction, status
+using ElevatorStatusRow = std::tuple<int, int, int, Direction, ElevatorStatus>;
+
+// Per-car counters for the metrics endpoint
+struct ElevatorMetrics {
+    int id;
+    uint64_t trips;
+    uint64_t floorsTravelled;
+    uint64_t doorCycles;
+    size_t queueDepth;
+    int load;
+    int capacity;
+    uint64_t passengersDelivered;
+};
 
 class ElevatorController {
 private:
-    std::vector<std::unique_ptr<Elevator>> elevators;
+    // Declared first so it outlives the cars that publish into it
+    EventBus eventBus;
+    
+    // Cars are only ever added. Every thread reads them through carSet(), an
+    // immutable list and floor index published by pointer, so a car adopted
+    // from the database never changes a list another thread is reading.
+    // Replaced sets are kept until destruction, one per adoption.
+    struct CarSet {
+        std::vector<Elevator*> elevators;
+        // Per floor, the cars (by index into elevators) that stop there. Dispatch
+        // only scores cars in the intersection of the pickup and destination masks.
+        std::vector<Bitmask> floorCars;
+    };
+    std::vector<std::unique_ptr<Elevator>> ownedCars;
+    std::vector<std::unique_ptr<const CarSet>> carSets;
+    std::atomic<const CarSet*> currentCars{nullptr};
+    const CarSet& carSet() const { return *currentCars.load(std::memory_order_acquire); }
+    // Publish a set built from ownedCars; called by one thread at a time
+    // (construction and setup before start(), then only the sync thread)
+    void publishCarSet();
+    
     std::vector<std::thread> elevatorThreads;
     std::queue<Request> pendingRequests;
-    std::mutex requestMutex;
-    std::condition_variable requestCV;
+    mutable ProfiledMutex requestMutex{"ElevatorController::requestMutex"};
+    std::condition_variable_any requestCV;
     std::atomic<bool> running;
     std::thread dispatcherThread;
-    std::unique_ptr<DatabaseLogger> dbLogger;
+    std::unique_ptr<EventSink> eventSink;
+    
+    // Forwards bus events to the sink off the dispatcher and car threads.
+    // Subscribed at construction so events before start() are kept. Like any
+    // subscriber it never stalls a car: when the sink falls SINK_QUEUE_CAPACITY
+    // events behind, new events are dropped and reported as the sink's dropped
+    // events.
+    std::shared_ptr<EventSubscription> sinkSubscription;
+    std::thread sinkThread;
+    std::atomic<bool> sinkRunning;
+    static constexpr size_t SINK_QUEUE_CAPACITY = 8192;
+    void sinkLoop();
+    
+    // Dispatcher timings: time a request waited in pendingRequests, and time
+    // spent choosing and handing it to a car
+    LatencyHistogram queueWaitLatency;
+    LatencyHistogram dispatchLatency;
     
     // Configuration
     int numElevators;
     int numFloors;
+    // CPU the dispatcher thread is pinned to, -1 to leave it unpinned
+    int dispatcherCpu;
+    // Whether database sync creates local cars for unknown rows in the
+    // elevators table (mirroring another instance of the same building)
+    bool adoptDatabaseElevators;
+    
+    // Motion model shared by every car; dispatch costs come from its table
+    KinematicConfig kinematics;
+    std::shared_ptr<const TravelTimeTable> travelTimes;
     
+    // Serializes car assignment between the dispatcher and keypad entries so
+    // two passengers for the same trip cannot open separate groups. A request
+    // only leaves the pending queue or a car's queue under it, so snapshot()
+    // holds it to see every request exactly once.
+    mutable ProfiledMutex assignMutex{"ElevatorController::assignMutex"};
+    std::atomic<DispatchMode> dispatchMode;
+    // Requests that joined a trip already queued on a car
+    std::atomic<uint64_t> groupedRequests;
+    
+    // The dispatcher revisits assignments and idle cars this often
+    static constexpr std::chrono::milliseconds REBALANCE_INTERVAL{1000};
+    
+    // Queued calls move to another car if it would reach the pickup at least
+    // REASSIGN_MIN_GAIN (simulated time) sooner, so calls do not stay stuck
+    // behind a delayed or stopped car
+    std::atomic<bool> reassignCalls;
+    std::atomic<uint64_t> reassignedRequests;
+    std::vector<QueuedCall> reassignScratch;  // dispatcher thread only
+    static constexpr std::chrono::milliseconds REASSIGN_MIN_GAIN{5000};
+    void reassignQueuedCalls();
+    
+    // Idle cars are spread over the floors where calls are expected, learned
+    // per floor and time of day from the calls made, so the first call in
+    // each zone finds a car waiting. A floor an idle car already waits at
+    // scores PARK_STAY_BONUS higher, so small shifts in demand do not
+    // shuffle cars around.
+    ArrivalStats arrivalStats;
+    std::atomic<bool> parkIdle;
+    std::atomic<uint64_t> parkingMoves;
+    static constexpr double PARK_MIN_DEMAND = 1.0;  // expected calls per slot
+    static constexpr double PARK_STAY_BONUS = 0.2;
+    // Dispatcher thread only
+    std::vector<double> parkingDemand;
+    std::vector<double> parkingCover;
+    std::vector<Elevator*> parkingCars;
+    std::vector<int> parkingFloors;
+    void parkIdleCars();
+    
+    // Periodic checkpoints of the full controller state; empty path disables
+    std::string checkpointPath;
+    std::chrono::milliseconds checkpointInterval{0};
+    std::thread checkpointThread;
+    ProfiledMutex checkpointMutex{"ElevatorController::checkpointMutex"};
+    std::condition_variable_any checkpointCV;
+    void checkpointLoop();
+    
+    // Car states are written to the database when the bus reports a change,
+    // and other instances' cars are adopted every SYNC_ADOPT_INTERVAL
     std::thread syncThread;
     std::atomic<bool> syncRunning;
+    std::shared_ptr<EventSubscription> syncSubscription;
+    static constexpr std::chrono::milliseconds SYNC_ADOPT_INTERVAL{1000};
     void startSyncThread();
     void syncWithDatabase();
     
+    // Publish an event on the bus: the recent-event ring, the sink and any
+    // other subscriber
+    void logEvent(LogEventType eventType, int elevatorId = -1, int fromFloor = -1, int toFloor = -1);
+    
+    // How long the dispatcher waits before retrying when every candidate car
+    // is full or stopped
+    static constexpr std::chrono::milliseconds DISPATCH_RETRY_INTERVAL{100};
+    
     void dispatcherLoop();
-    Elevator* findBestElevator(const Request& request);
+    // Lowest-ETA car with room for request, other than exclude
+    Elevator* findBestElevator(const Request& request, const Elevator* exclude = nullptr);
+    // Hand a request to a car (joining a queued trip in destination mode);
+    // returns the car or nullptr if none can take it now. Caller holds assignMutex.
+    Elevator* assignRequest(const Request& request);
+    bool isServable(int fromFloor, int toFloor) const;
+    bool validateRequest(int fromFloor, int toFloor, int passengers) const;
     
 public:
-    ElevatorController(int elevators = 3, int floors = 10);
+    // How long destination dispatch holds the doors at a pickup floor
+    static constexpr std::chrono::milliseconds DESTINATION_BOARDING_HOLD{1000};
+    
+    // Cars are numbered firstElevatorId, firstElevatorId + 1, ... so several
+    // controllers can share one database and metrics namespace. Events go to
+    // eventSink, or to PostgreSQL when none is given.
+    ElevatorController(int elevators = 3, int floors = 10, int firstElevatorId = 0,
+                       std::unique_ptr<EventSink> eventSink = nullptr);
     ~ElevatorController();
     
     void start();
     void stop();
     void emergencyStop();
     void releaseEmergencyStop();
-    void addRequest(int fromFloor, int toFloor, Direction direction);
+    // Returns false if the request was rejected: a floor is out of range, or
+    // no single car serves both floors
+    bool addRequest(int fromFloor, int toFloor, Direction direction, int passengers = 1);
+    
+    // Lobby keypad entry: origin and destination at once. Returns the id of
+    // the car the passengers should board, -1 if the call was queued until a
+    // car frees up, or std::nullopt if it was rejected.
+    std::optional<int> addDestinationCall(int fromFloor, int toFloor, int passengers = 1);
+    
+    void setDispatchMode(DispatchMode mode);
+    DispatchMode getDispatchMode() const;
+    uint64_t getGroupedRequestCount() const;
+    
+    // Move queued calls between cars as ETAs change (on by default)
+    void setCallReassignment(bool enabled);
+    bool isCallReassignmentEnabled() const;
+    uint64_t getReassignedRequestCount() const;
+    
+    // Reposition idle cars by learned demand (off by default)
+    void setParkingPolicy(bool enabled);
+    bool isParkingPolicyEnabled() const;
+    uint64_t getParkingMoveCount() const;
     
     // Status information
     std::vector<std::tuple<int, int, int, Direction, ElevatorStatus>> getElevatorStatuses() const;
     
+    // Fill a caller-owned vector so repeated polling can reuse its capacity
+    void getElevatorStatuses(std::vector<ElevatorStatusRow>& out) const;
+    
+    // Newest events from the in-memory ring (no database round trip)
+    std::vector<EventRecord> getRecentEvents(size_t limit) const;
+    size_t getRecentEventCapacity() const;
+    // Subscribe here to react to events instead of polling
+    EventBus& getEventBus();
+    
+    // Older history from the database, newest first. Pass the oldest ring
+    // record's time as `before` to continue where getRecentEvents() ends.
+    std::vector<EventSink::LogRow> getLoggedEvents(int limit, std::chrono::system_clock::time_point before = std::chrono::system_clock::time_point::max());
+    
+    // Metrics
+    void getElevatorMetrics(std::vector<ElevatorMetrics>& out) const;
+    size_t getPendingRequestCount() const;
+    LatencyHistogram::Snapshot getQueueWaitLatency() const;
+    LatencyHistogram::Snapshot getDispatchLatency() const;
+    LatencyHistogram::Snapshot getDatabaseWriteLatency() const;
+    EventSink::EventCounters getDatabaseEventCounters() const;
+    size_t getBufferedDatabaseEvents() const;
+    // Passengers delivered in the last Elevator::HANDLING_CAPACITY_WINDOW
+    int getHandlingCapacity() const;
+    uint64_t getPassengersDelivered() const;
+    
     // Configuration getters
     int getNumElevators() const;
     int getNumFloors() const;
     
+    // Call before start()
+    void setDispatcherCpu(int cpu);
+    void setAdoptDatabaseElevators(bool adopt);
+    // Limit a car (by id) to the floors set in a mask of size numFloors + 1
+    bool setServedFloors(int elevatorId, const Bitmask& floors);
+    bool hasElevator(int elevatorId) const;
+    // Passenger capacity of one car, or of every car with elevatorId -1
+    bool setCapacity(int elevatorId, int passengers);
+    // Motion limits, storey heights and door timings for every car
+    bool setKinematics(const KinematicConfig& config);
+    const KinematicConfig& getKinematics() const;
+    const TravelTimeTable& getTravelTimes() const;
+    
+    // Cars, queued and in-flight trips, pending requests, emergency flags
+    // and dispatch mode
+    ControllerSnapshot snapshot() const;
+    // Resume from a snapshot of a building with the same floor count. Call
+    // before start(). Work for cars that no longer exist goes back to the
+    // pending queue.
+    bool restore(const ControllerSnapshot& snapshot);
+    // Checkpoint to path every interval while running, and once more on
+    // stop(). Call before start().
+    void setCheckpointFile(const std::string& path, std::chrono::milliseconds interval);
+    bool writeCheckpoint() const;
+    
     void syncElevatorStates();
 }; 
\ No newline at end of file
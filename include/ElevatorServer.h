@@ -1,37 +1,132 @@
 #pragma once
 
-#include "ElevatorController.h"
+#include "ShardedController.h"
+#include "ProfiledMutex.h"
 #include <string>
 #include <thread>
 #include <mutex>
 #include <vector>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <functional>
+#include <string_view>
 #include <unordered_map>
 #include <netinet/in.h>
 
 class ElevatorServer {
 private:
-    ElevatorController& controller;
+    ShardedController& shards;
     std::atomic<bool> running;
     int port;
     int serverSocket;
     std::thread serverThread;
-    std::mutex clientsMutex;
-    std::vector<std::thread> clientThreads;
-    std::unordered_map<int, bool> activeClients;  // socket fd -> active status
     
+    // One entry per live connection thread. Sessions are keyed by a
+    // connection id rather than the socket fd because fds are reused as
+    // soon as a client closes.
+    struct ClientSession {
+        int socket;
+        std::thread thread;
+        std::atomic<bool> finished{false};
+    };
+    ProfiledMutex clientsMutex{"ElevatorServer::clientsMutex"};
+    std::unordered_map<uint64_t, std::unique_ptr<ClientSession>> clients;
+    uint64_t nextConnectionId;
+    
+    // Connection limits
+    size_t maxConnections;
+    std::chrono::seconds idleTimeout;
+    
+    // Connection counters
+    std::atomic<size_t> activeConnections;
+    std::atomic<uint64_t> acceptedConnections;
+    std::atomic<uint64_t> rejectedConnections;
+    std::atomic<uint64_t> timedOutConnections;
+    
+    // HTTP endpoint for /metrics and /status, served from the same select()
+    // loop as the command port. 0 disables it.
+    int metricsPort;
+    int httpSocket;
+    // Scratch buffers for HTTP replies, only touched by the server thread
+    std::string httpRequest;
+    std::string httpBody;
+    std::string httpResponse;
+    std::vector<ElevatorStatusRow> httpStatusRows;
+    std::vector<ElevatorMetrics> httpMetricsRows;
+    
+    static constexpr size_t INPUT_BUFFER_SIZE = 1024;
+    static constexpr size_t HTTP_MAX_REQUEST_SIZE = 8192;
+    // Scrapes are served inline on the server thread, so each one gets this
+    // long in total to send its request and take the response
+    static constexpr std::chrono::milliseconds HTTP_REQUEST_DEADLINE{1000};
+    static constexpr size_t OUTPUT_BUFFER_RESERVE = 4096;
+    // Queued output above which a client is considered too slow and dropped
+    static constexpr size_t SEND_HIGH_WATER_MARK = 256 * 1024;
+    // select() timeout while a client is watching events
+    static constexpr long WATCH_POLL_INTERVAL_US = 100000;
+    
+    // Per-connection state. Buffers keep their capacity between commands so
+    // steady-state status replies do not allocate.
+    struct ClientConnection {
+        int socket;
+        std::string input;
+        std::string output;
+        std::vector<ElevatorStatusRow> statusRows;
+        // Shard that commands are routed to unless prefixed with 'shard <id>'
+        size_t shard;
+        
+        // Bytes accepted for sending but not yet taken by the kernel
+        std::string pending;
+        size_t pendingOffset;
+        // Set when the connection must be dropped (write error or slow consumer)
+        bool closing;
+        
+        // Live event stream started by 'watch', drained between reads
+        std::shared_ptr<EventSubscription> watch;
+        EventBus* watchedBus;
+        
+        explicit ClientConnection(int clientSocket);
+        size_t pendingBytes() const { return pending.size() - pendingOffset; }
+    };
+    
+    int openListeningSocket(int listenPort);
     void serverLoop();
-    void handleClient(int clientSocket);
-    void processCommand(int clientSocket, const std::string& command);
-    void sendResponse(int clientSocket, const std::string& response);
-    std::string getElevatorStatusJson() const;
+    void acceptClient();
+    void handleHttpClient();
+    void writePrometheusMetrics(std::string& out);
+    void reapFinishedClients();
+    void handleClient(ClientSession* session);
+    void processCommand(ClientConnection& client, const std::string& command);
+    void sendResponse(ClientConnection& client, std::string_view response);
+    void flushPending(ClientConnection& client);
+    void sendWatchedEvents(ClientConnection& client);
+    void stopWatching(ClientConnection& client);
+    void writeElevatorStatusJson(std::string& out, const ElevatorController& controller,
+                                 std::vector<ElevatorStatusRow>& rows) const;
+    void writeShardedStatusJson(std::string& out, std::vector<ElevatorStatusRow>& rows) const;
+    std::string getShardListText(size_t currentShard) const;
+    std::string getRecentEventsText(ElevatorController& controller, int count);
     
 public:
-    ElevatorServer(ElevatorController& controller, int port = 8081);
+    ElevatorServer(ShardedController& shards, int port = 8081);
     ~ElevatorServer();
     
     bool start();
     void stop();
     bool isRunning() const { return running; }
+    
+    // Connection limits; call before start()
+    void setMaxConnections(size_t limit);
+    void setIdleTimeout(std::chrono::seconds timeout);
+    void setMetricsPort(int listenPort);
+    
+    struct ConnectionStats {
+        size_t active;
+        uint64_t accepted;
+        uint64_t rejected;
+        uint64_t timedOut;
+    };
+    ConnectionStats getConnectionStats() const;
 }; 
\ No newline at end of file
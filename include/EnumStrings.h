@@ -0,0 +1,129 @@
+#pragma once
+
+#include "DispatchMode.h"
+#include "Elevator.h"
+#include "LogEventType.h"
+#include "TrafficProfile.h"
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+// Display and protocol names for the simulation's enums, shared by the
+// server, the terminal UI and the database logger. Every entry is a string
+// literal, so data() is always null-terminated.
+
+constexpr std::array<std::string_view, 3> DIRECTION_NAMES = {
+    "Idle", "Up", "Down"
+};
+
+constexpr std::array<std::string_view, 4> ELEVATOR_STATUS_NAMES = {
+    "Idle", "Moving", "Stopped", "EMERGENCY"
+};
+
+constexpr std::array<std::string_view, 14> LOG_EVENT_TYPE_NAMES = {
+    "CALL_REQUEST",
+    "ELEVATOR_DISPATCHED",
+    "ELEVATOR_ARRIVED",
+    "DOOR_OPENED",
+    "DOOR_CLOSED",
+    "EMERGENCY_STOP",
+    "EMERGENCY_RELEASED",
+    "SYSTEM_STARTED",
+    "SYSTEM_STOPPED",
+    "SYNC_EVENT",
+    "ELEVATOR_DEPARTED",
+    "FLOOR_PASSED",
+    "CALL_REASSIGNED",
+    "ELEVATOR_PARKING"
+};
+
+constexpr std::array<std::string_view, 2> DISPATCH_MODE_NAMES = {
+    "conventional", "destination"
+};
+
+constexpr std::array<std::string_view, 4> TRAFFIC_PROFILE_NAMES = {
+    "up-peak", "down-peak", "lunch", "interfloor"
+};
+
+static_assert(DIRECTION_NAMES.size() == static_cast<size_t>(Direction::DOWN) + 1,
+              "DIRECTION_NAMES out of sync with Direction");
+static_assert(ELEVATOR_STATUS_NAMES.size() == static_cast<size_t>(ElevatorStatus::EMERGENCY) + 1,
+              "ELEVATOR_STATUS_NAMES out of sync with ElevatorStatus");
+static_assert(LOG_EVENT_TYPE_NAMES.size() == static_cast<size_t>(LogEventType::ELEVATOR_PARKING) + 1,
+              "LOG_EVENT_TYPE_NAMES out of sync with LogEventType");
+static_assert(DISPATCH_MODE_NAMES.size() == static_cast<size_t>(DispatchMode::DESTINATION) + 1,
+              "DISPATCH_MODE_NAMES out of sync with DispatchMode");
+static_assert(TRAFFIC_PROFILE_NAMES.size() == static_cast<size_t>(TrafficProfile::INTERFLOOR) + 1,
+              "TRAFFIC_PROFILE_NAMES out of sync with TrafficProfile");
+
+constexpr std::string_view toString(Direction direction) {
+    return DIRECTION_NAMES[static_cast<size_t>(direction)];
+}
+
+constexpr std::string_view toString(ElevatorStatus status) {
+    return ELEVATOR_STATUS_NAMES[static_cast<size_t>(status)];
+}
+
+constexpr std::string_view toString(LogEventType eventType) {
+    return LOG_EVENT_TYPE_NAMES[static_cast<size_t>(eventType)];
+}
+
+constexpr std::string_view toString(DispatchMode mode) {
+    return DISPATCH_MODE_NAMES[static_cast<size_t>(mode)];
+}
+
+constexpr std::string_view toString(TrafficProfile profile) {
+    return TRAFFIC_PROFILE_NAMES[static_cast<size_t>(profile)];
+}
+
+namespace detail {
+
+constexpr char asciiLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+constexpr bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (asciiLower(a[i]) != asciiLower(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Enum, size_t N>
+constexpr std::optional<Enum> parseEnum(const std::array<std::string_view, N>& names, std::string_view text) {
+    for (size_t i = 0; i < N; i++) {
+        if (equalsIgnoreCase(names[i], text)) {
+            return static_cast<Enum>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace detail
+
+// Reverse lookups, case-insensitive so protocol tokens such as "up" match
+constexpr std::optional<Direction> parseDirection(std::string_view text) {
+    return detail::parseEnum<Direction>(DIRECTION_NAMES, text);
+}
+
+constexpr std::optional<ElevatorStatus> parseElevatorStatus(std::string_view text) {
+    return detail::parseEnum<ElevatorStatus>(ELEVATOR_STATUS_NAMES, text);
+}
+
+constexpr std::optional<LogEventType> parseLogEventType(std::string_view text) {
+    return detail::parseEnum<LogEventType>(LOG_EVENT_TYPE_NAMES, text);
+}
+
+constexpr std::optional<DispatchMode> parseDispatchMode(std::string_view text) {
+    return detail::parseEnum<DispatchMode>(DISPATCH_MODE_NAMES, text);
+}
+
+constexpr std::optional<TrafficProfile> parseTrafficProfile(std::string_view text) {
+    return detail::parseEnum<TrafficProfile>(TRAFFIC_PROFILE_NAMES, text);
+}
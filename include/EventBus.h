@@ -0,0 +1,116 @@
+#pragma once
+
+#include "EventRing.h"
+#include "LogEventType.h"
+#include "ProfiledMutex.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// One subscriber's view of an EventBus: a bounded lock-free queue that any
+// number of publishers push into and a single consumer drains. A full queue
+// drops the new event and counts it, so a slow subscriber never stalls a car.
+class EventSubscription {
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        EventRecord record;
+    };
+    
+    std::unique_ptr<Slot[]> slots;
+    size_t capacity;
+    size_t mask;
+    uint32_t typeMask;
+    
+    // Publishers and the consumer each advance their own index, on separate
+    // cache lines
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) uint64_t head;
+    std::atomic<uint64_t> dropped;
+    
+    // The consumer parks here only when the queue is empty
+    std::atomic<bool> consumerWaiting;
+    std::atomic<bool> woken;
+    ProfiledMutex waitMutex{"EventSubscription::waitMutex"};
+    std::condition_variable_any waitCV;
+    
+    bool hasEvents() const;
+
+public:
+    // Capacity is rounded up to the next power of two
+    EventSubscription(uint32_t typeMask, size_t minCapacity);
+    
+    bool wants(LogEventType type) const { return typeMask & (1u << static_cast<int>(type)); }
+    
+    // Publisher side; false if the queue was full and the event dropped
+    bool push(const EventRecord& record);
+    
+    // Consumer side. poll() never blocks; waitFor() returns once events are
+    // queued, wake() is called or the timeout passes.
+    bool poll(EventRecord& out);
+    bool waitFor(std::chrono::milliseconds timeout);
+    void wake();
+    
+    uint64_t getDropped() const;
+};
+
+// In-process publish/subscribe hub for controller and car events. Publishing
+// records the event in a history ring and pushes it into the queue of every
+// subscriber whose type mask accepts it. Publishers reach the subscriber list
+// without a lock; the only lock they can take is a subscription's wait mutex,
+// to wake a consumer parked on an empty queue.
+class EventBus {
+public:
+    static constexpr uint32_t ALL_EVENTS = ~0u;
+    static constexpr size_t DEFAULT_QUEUE_CAPACITY = 1024;
+    
+    static constexpr uint32_t typeBit(LogEventType type) { return 1u << static_cast<int>(type); }
+    
+    explicit EventBus(size_t historyCapacity = 256);
+    ~EventBus();
+    
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+    
+    std::shared_ptr<EventSubscription> subscribe(uint32_t typeMask = ALL_EVENTS,
+                                                 size_t queueCapacity = DEFAULT_QUEUE_CAPACITY);
+    void unsubscribe(const std::shared_ptr<EventSubscription>& subscription);
+    
+    void publish(LogEventType type, int elevatorId, int fromFloor, int toFloor);
+    
+    // Newest events first, as EventRing::snapshot
+    size_t getRecent(std::vector<EventRecord>& out, size_t limit) const;
+    size_t getHistoryCapacity() const;
+    
+    // Events published per type, and events dropped by full subscriber queues
+    uint64_t getPublishedCount(LogEventType type) const;
+    uint64_t getDroppedCount() const;
+
+private:
+    using SubscriberList = std::vector<std::shared_ptr<EventSubscription>>;
+    
+    struct alignas(64) ReaderCount {
+        std::atomic<uint64_t> count{0};
+    };
+    
+    EventRing history;
+    // Copy-on-write list read through a raw pointer. A publisher counts itself
+    // in readers[readerEpoch] while it iterates. A writer swaps in the new list,
+    // then flips the epoch twice, each time waiting for the counter it left to
+    // drain, before freeing the old list; publishers arriving meanwhile count
+    // in the other slot, so a steady stream of events cannot hold it up.
+    std::atomic<const SubscriberList*> subscribers;
+    std::atomic<unsigned> readerEpoch;
+    std::array<ReaderCount, 2> readers;
+    mutable ProfiledMutex subscribeMutex{"EventBus::subscribeMutex"};
+    std::array<std::atomic<uint64_t>, 32> publishedByType{};
+    // Drops of subscriptions that have since unsubscribed
+    std::atomic<uint64_t> retiredDrops;
+    
+    // Publish updated and free the previous list; caller holds subscribeMutex
+    void replaceSubscribers(const SubscriberList* updated);
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "LogEventType.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Compact record of a single logged event
+struct EventRecord {
+    int64_t timestampMs;  // system_clock milliseconds since epoch
+    LogEventType type;
+    int elevatorId;
+    int fromFloor;
+    int toFloor;
+};
+
+// Fixed-capacity lock-free ring of the most recent events.
+// Writers claim a slot with a single fetch_add and publish it through a
+// per-slot sequence number; readers copy slots optimistically and skip any
+// slot that is overwritten while being read.
+class EventRing {
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<int64_t> timestampMs{0};
+        std::atomic<int> type{0};
+        std::atomic<int> elevatorId{0};
+        std::atomic<int> fromFloor{0};
+        std::atomic<int> toFloor{0};
+    };
+    
+    std::unique_ptr<Slot[]> slots;
+    size_t capacity;
+    size_t mask;
+    std::atomic<uint64_t> nextIndex;
+    
+public:
+    // Capacity is rounded up to the next power of two
+    explicit EventRing(size_t minCapacity = 256);
+    
+    void push(LogEventType type, int elevatorId, int fromFloor, int toFloor);
+    
+    // Copy up to `limit` of the newest events into `out`, newest first
+    size_t snapshot(std::vector<EventRecord>& out, size_t limit) const;
+    
+    size_t getCapacity() const;
+    
+    // Total number of events ever pushed (including overwritten ones)
+    uint64_t getTotalPushed() const;
+};
+
+// Format a record as "HH:MM:SS.mmm EVENT_TYPE elevator=.. from=.. to=.."
+std::string formatEventRecord(const EventRecord& record);
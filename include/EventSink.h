@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Elevator.h"
+#include "LogEventType.h"
+#include "Metrics.h"
+#include "ProfiledMutex.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Destination for controller events and, where the backend is shared between
+// instances, car state. ElevatorController takes one by injection, so the same
+// build can log to PostgreSQL, keep events in memory, append them to a file
+// or discard them.
+class EventSink {
+public:
+    using LogRow = std::tuple<std::string, std::string, int, int, int>;  // time, event, car, from, to
+    using ElevatorState = std::tuple<int, int, int, Direction, ElevatorStatus>;
+    
+    struct EventCounters {
+        uint64_t spilled = 0;     // Logged while disconnected
+        uint64_t replayed = 0;    // Written after reconnecting
+        uint64_t dropped = 0;     // Lost to the buffer bounds
+        uint64_t reconnects = 0;  // Connections re-established after a loss
+    };
+    
+    virtual ~EventSink() = default;
+    
+    // Called from ElevatorController::start() and stop(); must not block on I/O
+    virtual void open() {}
+    virtual void close() {}
+    // Ready to record; the state sync only runs while this is true
+    virtual bool isConnected() const = 0;
+    
+    virtual void logEvent(LogEventType eventType, int elevatorId, int fromFloor, int toFloor) = 0;
+    void logSystemEvent(LogEventType eventType) { logEvent(eventType, -1, -1, -1); }
+    
+    // Car state shared with other instances; local sinks keep only their own
+    virtual void syncElevatorState(int /*elevatorId*/, int /*currentFloor*/, int /*destFloor*/, int /*direction*/,
+                                   int /*status*/) {}
+    virtual std::vector<ElevatorState> getElevatorStates() { return {}; }
+    
+    // Recorded events older than `before`, newest first
+    virtual std::vector<LogRow> getRecentLogs(int /*limit*/ = 10, std::chrono::system_clock::time_point /*before*/ = std::chrono::system_clock::time_point::max()) {
+        return {};
+    }
+    
+    virtual LatencyHistogram::Snapshot getWriteLatency() const { return {}; }
+    virtual EventCounters getEventCounters() const { return {}; }
+    virtual size_t getBufferedEventCount() const { return 0; }
+
+protected:
+    static std::string formatTimestamp(std::chrono::system_clock::time_point time);
+};
+
+// Discards everything, for benchmarks that measure dispatch alone
+class NullEventSink : public EventSink {
+public:
+    bool isConnected() const override { return false; }
+    void logEvent(LogEventType /*eventType*/, int /*elevatorId*/, int /*fromFloor*/, int /*toFloor*/) override {}
+};
+
+// Keeps the newest events and the latest state of each car in memory
+class MemoryEventSink : public EventSink {
+public:
+    struct Event {
+        LogEventType eventType;
+        int elevatorId;
+        int fromFloor;
+        int toFloor;
+        std::chrono::system_clock::time_point time;
+    };
+    
+    explicit MemoryEventSink(size_t capacity = 100000);
+    
+    bool isConnected() const override { return true; }
+    void logEvent(LogEventType eventType, int elevatorId, int fromFloor, int toFloor) override;
+    void syncElevatorState(int elevatorId, int currentFloor, int destFloor, int direction, int status) override;
+    std::vector<ElevatorState> getElevatorStates() override;
+    std::vector<LogRow> getRecentLogs(int limit = 10, std::chrono::system_clock::time_point before = std::chrono::system_clock::time_point::max()) override;
+    
+    // Oldest first
+    std::vector<Event> getEvents() const;
+
+private:
+    size_t capacity;
+    std::deque<Event> events;
+    std::map<int, ElevatorState> states;
+    mutable ProfiledMutex mutex{"MemoryEventSink::mutex"};
+};
+
+// Appends one line per event to a file: time, event, car, from, to
+class JournalEventSink : public EventSink {
+public:
+    explicit JournalEventSink(const std::string& path);
+    
+    void open() override;
+    void close() override;
+    bool isConnected() const override;
+    void logEvent(LogEventType eventType, int elevatorId, int fromFloor, int toFloor) override;
+    std::vector<LogRow> getRecentLogs(int limit = 10, std::chrono::system_clock::time_point before = std::chrono::system_clock::time_point::max()) override;
+    
+    LatencyHistogram::Snapshot getWriteLatency() const override;
+
+private:
+    std::string path;
+    std::ofstream out;
+    mutable ProfiledMutex mutex{"JournalEventSink::mutex"};
+    LatencyHistogram writeLatency;
+};
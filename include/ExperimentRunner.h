@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Simulation.h"
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+// Parameter grid for a batch of headless simulations. Every combination of
+// policy, car count, capacity and traffic profile is run once per seed.
+struct ExperimentGrid {
+    std::vector<DispatchMode> policies{DispatchMode::CONVENTIONAL};
+    std::vector<int> cars{3};
+    std::vector<int> capacities{8};
+    std::vector<TrafficProfile> traffic{TrafficProfile::INTERFLOOR};
+    int floors = 10;
+    // Seeds firstSeed .. firstSeed + runs - 1; unset unless the spec gave a
+    // seed, in which case runs start at DEFAULT_FIRST_SEED
+    static constexpr uint64_t DEFAULT_FIRST_SEED = 1;
+    int runs = 10;
+    std::optional<uint64_t> firstSeed;
+    double passengersPerHour = 300.0;
+    std::chrono::seconds duration{std::chrono::hours(24)};
+    KinematicConfig kinematics;
+};
+
+// Parse "key=v1,v2;key=v;..." with keys policy, cars, capacity, traffic
+// (lists) and floors, runs, seed, rate, hours (single values), e.g.
+// "policy=conventional,destination;cars=4,6;traffic=up-peak;runs=100".
+// Missing keys keep their defaults.
+std::optional<ExperimentGrid> parseExperimentGrid(std::string_view spec);
+
+// KPIs of one grid cell, merged over all its seeds
+struct ExperimentRow {
+    DispatchMode policy;
+    int cars;
+    int capacity;
+    TrafficProfile traffic;
+    int runs;
+    SimulationResult total;
+};
+
+// Runs every simulation of a grid on a pool of worker threads. Each run owns
+// its simulation and writes only its own result slot; workers share nothing
+// but an atomic index into the run list.
+class ExperimentRunner {
+private:
+    ExperimentGrid grid;
+    unsigned jobs;
+    
+    std::vector<SimulationConfig> expandGrid() const;
+    
+public:
+    // jobs 0 uses every hardware thread
+    explicit ExperimentRunner(const ExperimentGrid& grid, unsigned jobs = 0);
+    
+    size_t getRunCount() const;
+    unsigned getJobCount() const { return jobs; }
+    std::vector<ExperimentRow> run();
+    
+    // One row per grid cell. Counts and energy are means per run; waits are
+    // over every passenger of the cell. event_digest combines the cell's run
+    // digests, so it changes only if some run behaved differently.
+    static void writeCsv(std::ostream& out, const std::vector<ExperimentRow>& rows);
+};
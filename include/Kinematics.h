@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Motion limits of a car. Defaults are typical of a mid-rise traction elevator.
+struct MotionProfile {
+    double maxSpeed = 2.5;      // m/s
+    double acceleration = 1.0;  // m/s^2
+    double jerk = 1.5;          // m/s^3
+};
+
+// Door operation at a stop. The doors stay open for the longer of the
+// minimum dwell and the time for everyone boarding or alighting to pass.
+struct DoorTiming {
+    int openMs = 800;
+    int closeMs = 1000;
+    int minDwellMs = 500;
+    int perPassengerMs = 600;
+    
+    std::chrono::milliseconds stopTime(int passengersExchanged) const;
+};
+
+// Time in seconds to travel distance metres from rest to rest under a
+// jerk-limited (S-curve) profile, in closed form
+double travelTimeSeconds(const MotionProfile& profile, double distance);
+
+// Floor-to-floor travel times for one shaft, computed once from the motion
+// profile and storey heights so dispatch can look them up in O(1)
+class TravelTimeTable {
+private:
+    int numFloors;
+    std::vector<double> positions;    // metres above floor 1, indexed by floor
+    std::vector<uint32_t> travelMs;   // [from * (numFloors + 1) + to]
+    
+public:
+    static constexpr double DEFAULT_FLOOR_HEIGHT = 3.5;  // metres
+    
+    // storeyHeights[i] is the height from floor i + 1 to floor i + 2; missing
+    // entries use the last given height (or DEFAULT_FLOOR_HEIGHT)
+    TravelTimeTable(int floors, const MotionProfile& profile = MotionProfile(),
+                    const std::vector<double>& storeyHeights = {});
+    
+    int getNumFloors() const { return numFloors; }
+    double floorPosition(int floor) const { return positions[floor]; }
+    
+    std::chrono::milliseconds travelTime(int fromFloor, int toFloor) const {
+        return std::chrono::milliseconds(travelMs[static_cast<size_t>(fromFloor) * (numFloors + 1) + toFloor]);
+    }
+};
+
+// Everything that shapes how long a car spends between and at floors
+struct KinematicConfig {
+    MotionProfile motion;
+    DoorTiming doors;
+    // Storey heights from floor 1 up; empty uses DEFAULT_FLOOR_HEIGHT throughout
+    std::vector<double> storeyHeights;
+    // Simulated seconds per wall-clock second, so a realistic building runs
+    // at a watchable pace
+    double timeScale = 4.0;
+    
+    std::shared_ptr<const TravelTimeTable> buildTable(int floors) const {
+        return std::make_shared<const TravelTimeTable>(floors, motion, storeyHeights);
+    }
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+enum class LogEventType {
+    CALL_REQUEST,
+    ELEVATOR_DISPATCHED,
+    ELEVATOR_ARRIVED,
+    DOOR_OPENED,
+    DOOR_CLOSED,
+    EMERGENCY_STOP,
+    EMERGENCY_RELEASED,
+    SYSTEM_STARTED,
+    SYSTEM_STOPPED,
+    SYNC_EVENT,
+    ELEVATOR_DEPARTED,  // A car starts a run: from its floor towards the target
+    FLOOR_PASSED,       // A car moves on one floor during a run
+    CALL_REASSIGNED,    // A queued call moved to a car that can reach it sooner
+    ELEVATOR_PARKING    // An idle car is sent to wait where calls are expected
+};
+
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Latency histogram with fixed buckets. Each recording thread gets its own
+// shard of relaxed atomic counters, so instrumented hot paths never write to
+// a cache line shared with another thread; shards are summed on scrape.
+class LatencyHistogram {
+public:
+    // Upper bounds of the finite buckets in microseconds; a final +Inf
+    // bucket catches everything above the last bound
+    static constexpr std::array<uint64_t, 14> BUCKET_BOUNDS_US = {
+        50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+        100000, 250000, 1000000, 5000000
+    };
+    static constexpr size_t NUM_BUCKETS = BUCKET_BOUNDS_US.size() + 1;
+    
+    struct Snapshot {
+        std::array<uint64_t, NUM_BUCKETS> buckets{};  // non-cumulative counts
+        uint64_t count = 0;
+        uint64_t sumNanos = 0;
+    };
+    
+    LatencyHistogram();
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+    
+    void record(std::chrono::nanoseconds elapsed);
+    Snapshot snapshot() const;
+    
+private:
+    struct Shard {
+        std::thread::id owner;
+        std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets{};
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sumNanos{0};
+    };
+    
+    Shard& localShard();
+    
+    // Each thread caches its shards in THREAD_CACHE_SLOTS slots indexed by
+    // histogram id. Ids are unique for the life of the process, so an entry
+    // left by a destroyed histogram never matches and is simply overwritten.
+    static constexpr size_t THREAD_CACHE_SLOTS = 64;
+    const uint64_t histogramId;
+    
+    // Only taken on a thread's cache miss and on scrape
+    mutable std::mutex shardsMutex;
+    std::vector<std::unique_ptr<Shard>> shards;
+};
+
+// Upper bound (in microseconds) of the bucket containing quantile q of the
+// samples; samples in the +Inf bucket report the largest finite bound
+uint64_t approximateQuantileUs(const LatencyHistogram::Snapshot& snapshot, double q);
+
+// Measures the lifetime of a scope into a histogram
+class ScopedLatency {
+public:
+    explicit ScopedLatency(LatencyHistogram& histogram)
+        : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+    ~ScopedLatency() {
+        histogram.record(std::chrono::steady_clock::now() - start);
+    }
+    
+private:
+    LatencyHistogram& histogram;
+    std::chrono::steady_clock::time_point start;
+};
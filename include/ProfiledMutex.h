@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Metrics.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Statistics shared by every mutex constructed with the same name (e.g. all
+// cars' request mutexes report as one lock)
+struct LockProfile {
+    std::string name;
+    std::string waitSpanName;               // trace span for contended waits
+    LatencyHistogram waitTime;              // one sample per acquisition
+    LatencyHistogram holdTime;              // one sample per release
+    std::atomic<uint64_t> contended{0};     // acquisitions that had to block
+    
+    explicit LockProfile(const std::string& lockName)
+        : name(lockName), waitSpanName(lockName + " wait") {}
+};
+
+// Registry of lock profiles, reported through the server and at shutdown
+class LockProfiler {
+public:
+    static LockProfiler& instance();
+    
+    // Get or create the profile for a lock name
+    LockProfile& profile(const std::string& name);
+    
+    struct LockReport {
+        std::string name;
+        uint64_t acquisitions;
+        uint64_t contended;
+        LatencyHistogram::Snapshot wait;
+        LatencyHistogram::Snapshot hold;
+    };
+    std::vector<LockReport> report() const;
+    
+    // Human-readable table of every lock, sorted by total wait time
+    std::string formatReport() const;
+    
+private:
+    LockProfiler() = default;
+    
+    mutable std::mutex profilesMutex;
+    std::map<std::string, std::unique_ptr<LockProfile>> profiles;
+};
+
+// Drop-in replacement for std::mutex that records acquisition counts and
+// wait/hold time histograms. Uncontended acquisitions take the try_lock fast
+// path and only pay for the clock reads. Use std::condition_variable_any
+// when waiting on it.
+class ProfiledMutex {
+public:
+    explicit ProfiledMutex(const std::string& name);
+    ProfiledMutex(const ProfiledMutex&) = delete;
+    ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+    
+    void lock();
+    bool try_lock();
+    void unlock();
+    
+private:
+    std::mutex mutex;
+    LockProfile& profile;
+    // Written only by the current owner
+    std::chrono::steady_clock::time_point acquiredAt;
+};
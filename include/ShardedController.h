@@ -0,0 +1,83 @@
+#pragma once
+
+#include "ElevatorController.h"
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// One building or bank of cars: a name, its car count and the floors it serves
+struct ShardConfig {
+    std::string name;
+    int elevators;
+    int floors;
+};
+
+// Parse "name:cars:floors[,name:cars:floors...]" into shard configs.
+// Returns std::nullopt if any entry is malformed, a name has characters other
+// than letters, digits, '_' and '-', names repeat, a shard has no cars or fewer
+// than two floors.
+std::optional<std::vector<ShardConfig>> parseShardSpec(std::string_view spec);
+
+// Per-shard file for a shared path: path itself with one shard, otherwise
+// path.<name>
+std::string getShardPath(const std::string& path, const std::vector<ShardConfig>& configs, size_t shardId);
+
+// Owns one ElevatorController per shard. Each shard has its own cars, request
+// queue and dispatcher thread, so shards never contend with each other. Car
+// ids are numbered consecutively across shards so they stay unique in logs,
+// metrics and the database.
+class ShardedController {
+public:
+    // Builds the event sink of shard i; null means PostgreSQL
+    using EventSinkFactory = std::function<std::unique_ptr<EventSink>(size_t shardId)>;
+    
+private:
+    std::vector<ShardConfig> configs;
+    std::vector<std::unique_ptr<ElevatorController>> shards;
+    
+public:
+    // With pinDispatchers, shard i's dispatcher is pinned to the i-th CPU this
+    // process may run on (wrapping around when there are more shards than CPUs)
+    explicit ShardedController(const std::vector<ShardConfig>& shardConfigs, bool pinDispatchers = false,
+                               const EventSinkFactory& makeEventSink = nullptr);
+    ~ShardedController();
+    
+    void start();
+    void stop();
+    
+    size_t getShardCount() const { return shards.size(); }
+    
+    // Shard ids are indices into the config list; callers validate with findShard()
+    ElevatorController& getShard(size_t shardId) { return *shards[shardId]; }
+    const ElevatorController& getShard(size_t shardId) const { return *shards[shardId]; }
+    const ShardConfig& getShardConfig(size_t shardId) const { return configs[shardId]; }
+    
+    // Look a shard up by numeric id or name
+    std::optional<size_t> findShard(std::string_view idOrName) const;
+    
+    // Apply "cars=floors", e.g. "2-3=1,21-40", limiting the listed cars (by
+    // global id) to the listed floors of their shard. Call before start().
+    bool applyServedFloorsSpec(std::string_view spec);
+    
+    // Passenger capacity of every car; call before start()
+    bool setCapacity(int passengers);
+    void setDispatchMode(DispatchMode mode);
+    void setCallReassignment(bool enabled);
+    void setParkingPolicy(bool enabled);
+    // Motion model of every car; call before start()
+    bool setKinematics(const KinematicConfig& config);
+    
+    std::string getShardPath(const std::string& path, size_t shardId) const;
+    // Call before start()
+    void setCheckpointFile(const std::string& path, std::chrono::milliseconds interval);
+    // Restore every shard whose checkpoint under path exists and matches;
+    // returns how many were restored
+    size_t restoreCheckpoint(const std::string& path);
+    
+    // Totals across every shard
+    int getTotalElevators() const;
+    size_t getTotalPendingRequests() const;
+};
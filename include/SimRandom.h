@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+// Seeded random source for simulations and demos. The <random> distributions
+// are implemented differently by each standard library, so the same seed can
+// give different draws on another toolchain. Every draw here is fully
+// specified (xoshiro256** seeded through splitmix64), so a seed replays the
+// same sequence on any build.
+class SimRandom {
+private:
+    uint64_t state[4];
+    
+public:
+    explicit SimRandom(uint64_t seed);
+    
+    uint64_t next();
+    // Uniform in [0, 1) with 53 bits of precision
+    double uniform();
+    // Uniform in [low, high], without modulo bias
+    int uniformInt(int low, int high);
+    // Exponentially distributed with mean 1 / rate
+    double exponential(double rate);
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "DispatchMode.h"
+#include "Kinematics.h"
+#include "SimRandom.h"
+#include "TrafficProfile.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// One headless run: a building, a dispatch policy and a traffic pattern
+struct SimulationConfig {
+    DispatchMode policy = DispatchMode::CONVENTIONAL;
+    int cars = 3;
+    int floors = 10;
+    int capacity = 8;
+    TrafficProfile traffic = TrafficProfile::INTERFLOOR;
+    // Mean passenger arrivals per hour across the building (Poisson)
+    double passengersPerHour = 300.0;
+    // Simulated time during which passengers arrive; cars then finish their work
+    std::chrono::seconds duration{std::chrono::hours(24)};
+    uint64_t seed = 1;
+    // timeScale is ignored: nothing sleeps
+    KinematicConfig kinematics;
+};
+
+// KPIs of one run (or of several merged), in simulated time
+struct SimulationResult {
+    static constexpr int WAIT_BUCKET_MS = 500;
+    // The last bucket catches every wait of 10 minutes or more
+    static constexpr size_t WAIT_BUCKETS = 1200;
+    
+    uint64_t passengers = 0;  // delivered
+    uint64_t trips = 0;       // runs between two stops
+    uint64_t floorsTravelled = 0;
+    double totalWaitSeconds = 0.0;
+    double totalJourneySeconds = 0.0;
+    double energyKwh = 0.0;
+    // Hash of every event in the order processed. Equal digests for the same
+    // seed mean two builds made identical decisions at identical times.
+    uint64_t eventDigest = 0xcbf29ce484222325ULL;
+    std::vector<uint32_t> waitHistogram = std::vector<uint32_t>(WAIT_BUCKETS, 0);
+    
+    void recordWait(int64_t waitMs);
+    void recordEvent(int64_t timeMs, int subject, int detail);
+    void merge(const SimulationResult& other);
+    double averageWaitSeconds() const;
+    double averageJourneySeconds() const;
+    // Upper bound of the bucket holding quantile q of all waits
+    double waitQuantileSeconds(double q) const;
+};
+
+// Discrete-event simulation of one building on a simulated clock, with no
+// threads, sleeps or shared state, so many can run side by side. It is
+// deterministic: all randomness comes from the seed, and events at the same
+// instant are handled in a fixed order. Cars follow
+// the rules of Elevator and ElevatorController: each serves its queue in
+// order, a request goes to the car with the lowest ETA among those with
+// room, and destination dispatch groups passengers making the same trip.
+class Simulation {
+public:
+    // Energy model: the counterweight balances the car plus half its rated
+    // load, so the drive lifts the imbalance; lowering it is not regenerated
+    static constexpr double PASSENGER_MASS_KG = 75.0;
+    static constexpr double DRIVE_EFFICIENCY = 0.8;
+    static constexpr double RUNNING_LOSS_J_PER_M = 400.0;
+    static constexpr double DOOR_CYCLE_J = 1500.0;
+    
+    explicit Simulation(const SimulationConfig& config);
+    
+    SimulationResult run();
+    
+private:
+    // Passengers making the same trip, by arrival time (ms)
+    struct Group {
+        int fromFloor;
+        int toFloor;
+        std::vector<int64_t> arrivals;
+        int size() const { return static_cast<int>(arrivals.size()); }
+    };
+    
+    struct QueuedTrip {
+        Group group;
+        int64_t plannedMs;
+    };
+    
+    enum class Phase { IDLE, BOARDING, RIDING };
+    
+    // Mirrors one Elevator, including its ETA model
+    struct Car {
+        int floor = 1;
+        std::deque<QueuedTrip> queue;
+        Phase phase = Phase::IDLE;
+        Group active{0, 0, {}};
+        std::vector<int64_t> riders;  // arrival times of passengers on board
+        int64_t eventAt = 0;
+        int64_t activeDue = 0;
+        int64_t queuedWork = 0;
+        int committedEndFloor = 1;
+        int queuedPassengers = 0;
+    };
+    
+    SimulationConfig config;
+    TravelTimeTable table;
+    int64_t boardingHoldMs;
+    SimRandom rng;
+    std::vector<Car> cars;
+    std::deque<Group> pending;  // no car had room when these arrived
+    int64_t now;
+    SimulationResult result;
+    
+    int64_t travelMs(int fromFloor, int toFloor) const;
+    int64_t stopMs(int passengers) const;
+    int64_t plannedTripTime(int startFloor, const Group& group) const;
+    int64_t estimateTravelTime(const Car& car, int floor) const;
+    void recordRun(int fromFloor, int toFloor, int load);
+    
+    Group sampleArrival();
+    void dispatch(Group group);
+    bool joinTrip(const Group& group);
+    void enqueue(Car& car, Group group);
+    void retryPending();
+    void startTrip(Car& car);
+    void board(Car& car);
+    void finishTrip(Car& car);
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "DispatchMode.h"
+#include "Elevator.h"
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Work a car still owes: its current trip (re-issued from the car's floor
+// if the passengers already boarded) followed by its queue, in order
+struct CarSnapshot {
+    int id;
+    int floor;
+    bool emergency;
+    std::vector<Request> requests;
+};
+
+// Everything a controller needs to resume where it left off
+struct ControllerSnapshot {
+    int floors = 0;
+    DispatchMode dispatchMode = DispatchMode::CONVENTIONAL;
+    std::vector<CarSnapshot> cars;
+    // Requests no car had taken yet
+    std::vector<Request> pending;
+};
+
+// Compact little-endian encoding with a magic number, version and checksum.
+// decodeSnapshot returns std::nullopt for truncated, corrupt or foreign data.
+std::string encodeSnapshot(const ControllerSnapshot& snapshot);
+std::optional<ControllerSnapshot> decodeSnapshot(std::string_view data);
+
+// The file is replaced atomically (written beside it, then renamed), so a
+// crash mid-checkpoint leaves the previous checkpoint intact
+bool writeSnapshotFile(const std::string& path, const ControllerSnapshot& snapshot);
+std::optional<ControllerSnapshot> readSnapshotFile(const std::string& path);
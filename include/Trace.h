@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Low-overhead span tracing exported as Chrome trace JSON, which loads
+// directly in Perfetto or chrome://tracing. Each thread records into its own
+// fixed-size ring, so recording never takes a lock. Spans are only recorded
+// while tracing is enabled at runtime, and the TRACE_* macros compile to
+// nothing unless ELEVATOR_TRACING is defined (the ENABLE_TRACING CMake option).
+class Tracer {
+public:
+    static Tracer& instance();
+    
+    void setEnabled(bool enable);
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+    
+    // File written by dump()
+    void setOutputPath(const std::string& path);
+    std::string getOutputPath() const;
+    
+    // Label the calling thread in the exported trace
+    void setThreadName(const std::string& name);
+    
+    void record(const char* name, uint64_t startNs, uint64_t endNs);
+    
+    // Write all buffered spans to the output path; returns the number of
+    // spans written, or -1 if the file could not be opened
+    long dump() const;
+    
+    static uint64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    
+private:
+    static constexpr size_t EVENTS_PER_THREAD = 8192;
+    
+    // Single-writer ring owned by one thread at a time. Readers copy slots
+    // and discard any that the writer may have lapped while they were reading.
+    struct ThreadBuffer {
+        uint32_t threadId = 0;
+        std::string threadName;
+        bool inUse = true;
+        std::atomic<uint64_t> head{0};
+        struct Slot {
+            std::atomic<const char*> name{nullptr};
+            std::atomic<uint64_t> startNs{0};
+            std::atomic<uint64_t> endNs{0};
+        };
+        std::unique_ptr<Slot[]> slots{new Slot[EVENTS_PER_THREAD]};
+    };
+    
+    struct ThreadBufferHandle {
+        std::shared_ptr<ThreadBuffer> buffer;
+        ~ThreadBufferHandle();
+    };
+    
+    Tracer() = default;
+    ThreadBuffer& localBuffer();
+    void releaseBuffer(ThreadBuffer& buffer);
+    
+    std::atomic<bool> enabled{false};
+    
+    // Guards the buffer list, thread names and the output path. Not taken
+    // on the recording path once a thread owns its buffer.
+    mutable std::mutex buffersMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    uint32_t nextThreadId = 1;
+    std::string outputPath = "elevator_trace.json";
+};
+
+// Records the lifetime of a scope as one span
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* spanName)
+        : name(Tracer::instance().isEnabled() ? spanName : nullptr),
+          startNs(name ? Tracer::nowNs() : 0) {}
+    ~TraceSpan() {
+        if (name) {
+            Tracer::instance().record(name, startNs, Tracer::nowNs());
+        }
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+    
+private:
+    const char* name;
+    uint64_t startNs;
+};
+
+#ifdef ELEVATOR_TRACING
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceSpan TRACE_CONCAT(traceSpan_, __LINE__)(name)
+#define TRACE_THREAD_NAME(name) Tracer::instance().setThreadName(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#endif
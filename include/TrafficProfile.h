@@ -0,0 +1,13 @@
+#pragma once
+
+// Where passengers come from and go to in a simulated day
+enum class TrafficProfile {
+    // Mostly lobby to upper floors (morning arrival)
+    UP_PEAK,
+    // Mostly upper floors to the lobby (evening departure)
+    DOWN_PEAK,
+    // Even mix of trips to and from the lobby
+    LUNCH,
+    // Uniform trips between any two floors
+    INTERFLOOR
+};
@@ -1,11 +1,14 @@
 #pragma once
 
 #include "ElevatorController.h"
+#include "ProfiledMutex.h"
+#include <chrono>
 #include <string>
 #include <thread>
 #include <atomic>
 #include <mutex>
 #include <functional>
+#include <memory>
 
 class UserInterface {
 private:
@@ -13,9 +16,22 @@ private:
     std::thread inputThread;
     std::thread displayThread;
     std::atomic<bool> running;
-    std::mutex displayMutex;
+    ProfiledMutex displayMutex{"UserInterface::displayMutex"};
+    std::shared_ptr<EventSubscription> displayEvents;
+    
+    // Input is read from stdin in chunks, so a quiet terminal never blocks stop()
+    std::string inputBuffer;
+    bool inputClosed = false;
+    const std::chrono::milliseconds INPUT_POLL_INTERVAL{100};
+    
+    // Number of recent events shown below the status table
+    const size_t RECENT_EVENTS_SHOWN = 5;
+    // Event-driven redraws are spaced at least this far apart
+    const std::chrono::milliseconds MIN_REDRAW_INTERVAL{100};
     
     void inputLoop();
+    // Next line of input; false once stopped or at end of input
+    bool readLine(std::string& line);
     void displayLoop();
     void displayStatus();
     void displayHelp();
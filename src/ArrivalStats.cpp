@@ -0,0 +1,89 @@
+#include "ArrivalStats.h"
+#include <algorithm>
+#include <ctime>
+
+static constexpr int64_t SLOT_SECONDS = ArrivalStats::SLOT_MINUTES * 60;
+
+ArrivalStats::ArrivalStats(int floors, double smoothing)
+    : numFloors(floors),
+      smoothing(smoothing),
+      history(static_cast<size_t>(SLOTS_PER_DAY) * (floors + 1), 0.0),
+      slotSeen(SLOTS_PER_DAY, false),
+      lastSlot(floors + 1, 0.0),
+      live(floors + 1, 0.0),
+      currentSlot(-1),
+      recorded(0) {
+}
+
+int64_t ArrivalStats::localSlot(std::chrono::system_clock::time_point when, double* elapsed) {
+    std::time_t seconds = std::chrono::system_clock::to_time_t(when);
+    std::tm localTime;
+    localtime_r(&seconds, &localTime);
+    
+    int64_t localSeconds = static_cast<int64_t>(seconds) + localTime.tm_gmtoff;
+    int64_t slot = localSeconds / SLOT_SECONDS - (localSeconds % SLOT_SECONDS < 0 ? 1 : 0);
+    if (elapsed) {
+        *elapsed = static_cast<double>(localSeconds - slot * SLOT_SECONDS) / SLOT_SECONDS;
+    }
+    return slot;
+}
+
+void ArrivalStats::advanceTo(int64_t slot) {
+    if (currentSlot < 0) {
+        currentSlot = slot;
+        return;
+    }
+    
+    // After a day without calls every slot has been folded once; folding
+    // further empty days would only decay the history
+    int64_t folds = std::min<int64_t>(slot - currentSlot, SLOTS_PER_DAY);
+    for (int64_t i = 0; i < folds; i++) {
+        size_t daySlot = static_cast<size_t>((currentSlot + i) % SLOTS_PER_DAY);
+        double* rates = &history[daySlot * (numFloors + 1)];
+        for (int floor = 1; floor <= numFloors; floor++) {
+            rates[floor] = slotSeen[daySlot] ? (1.0 - smoothing) * rates[floor] + smoothing * live[floor] : live[floor];
+        }
+        slotSeen[daySlot] = true;
+        lastSlot.swap(live);
+        std::fill(live.begin(), live.end(), 0.0);
+    }
+    
+    if (slot > currentSlot) {
+        currentSlot = slot;
+    }
+}
+
+void ArrivalStats::record(int floor, std::chrono::system_clock::time_point when) {
+    if (floor < 1 || floor > numFloors) {
+        return;
+    }
+    
+    int64_t slot = localSlot(when, nullptr);
+    
+    std::lock_guard<ProfiledMutex> lock(statsMutex);
+    advanceTo(slot);
+    // A late call for an earlier slot counts towards the current one
+    live[floor] += 1.0;
+    recorded++;
+}
+
+void ArrivalStats::getRates(std::chrono::system_clock::time_point when, std::vector<double>& out) {
+    double elapsed = 0.0;
+    int64_t slot = localSlot(when, &elapsed);
+    
+    std::lock_guard<ProfiledMutex> lock(statsMutex);
+    advanceTo(slot);
+    
+    size_t daySlot = static_cast<size_t>(currentSlot % SLOTS_PER_DAY);
+    const double* base = slotSeen[daySlot] ? &history[daySlot * (numFloors + 1)] : lastSlot.data();
+    
+    out.assign(numFloors + 1, 0.0);
+    for (int floor = 1; floor <= numFloors; floor++) {
+        out[floor] = (1.0 - elapsed) * base[floor] + live[floor];
+    }
+}
+
+uint64_t ArrivalStats::getRecordedCount() const {
+    std::lock_guard<ProfiledMutex> lock(statsMutex);
+    return recorded;
+}
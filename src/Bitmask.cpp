@@ -0,0 +1,77 @@
+#include "Bitmask.h"
+#include <algorithm>
+#include <charconv>
+
+Bitmask::Bitmask(size_t numBits, bool value)
+    : words((numBits + 63) / 64, value ? ~uint64_t(0) : 0), bits(numBits) {
+    // Keep bits past the end clear so count() and comparisons stay exact
+    if (value && numBits % 64 != 0) {
+        words.back() &= (uint64_t(1) << (numBits % 64)) - 1;
+    }
+}
+
+void Bitmask::resize(size_t numBits) {
+    words.resize((numBits + 63) / 64, 0);
+    if (numBits < bits && numBits % 64 != 0) {
+        words.back() &= (uint64_t(1) << (numBits % 64)) - 1;
+    }
+    bits = numBits;
+}
+
+bool Bitmask::any() const {
+    return std::any_of(words.begin(), words.end(), [](uint64_t word) { return word != 0; });
+}
+
+size_t Bitmask::count() const {
+    size_t total = 0;
+    for (uint64_t word : words) {
+        total += static_cast<size_t>(__builtin_popcountll(word));
+    }
+    return total;
+}
+
+size_t Bitmask::first() const {
+    for (size_t i = 0; i < words.size(); i++) {
+        if (words[i] != 0) {
+            return i * 64 + static_cast<size_t>(__builtin_ctzll(words[i]));
+        }
+    }
+    return bits;
+}
+
+// Parse a whole string_view as an unsigned number
+static std::optional<size_t> parseIndex(std::string_view text) {
+    size_t value = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (text.empty() || result.ec != std::errc() || result.ptr != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::optional<Bitmask> parseBitList(std::string_view list, size_t minBit, size_t maxBit) {
+    Bitmask mask(maxBit + 1);
+    
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view entry = list.substr(0, comma);
+        list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+        
+        size_t dash = entry.find('-');
+        auto first = parseIndex(entry.substr(0, dash));
+        auto last = dash == std::string_view::npos ? first : parseIndex(entry.substr(dash + 1));
+        if (!first || !last || *first > *last || *first < minBit || *last > maxBit) {
+            return std::nullopt;
+        }
+        
+        for (size_t bit = *first; bit <= *last; bit++) {
+            mask.set(bit);
+        }
+    }
+    
+    if (!mask.any()) {
+        return std::nullopt;
+    }
+    
+    return mask;
+}
@@ -0,0 +1,109 @@
+#include "CarMailbox.h"
+
+#ifdef __linux__
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free,
+              "the futex word must be a plain 32-bit integer");
+#endif
+
+CarMailbox::CarMailbox()
+    : commands(0), parked(false), parkCount(0) {
+}
+
+void CarMailbox::post(uint32_t command) {
+    // Only the post that makes the word non-empty can find the car asleep;
+    // a car that parks later sees the word non-empty and does not sleep
+    uint32_t previous = commands.fetch_or(command, std::memory_order_seq_cst);
+    if (previous == 0 && parked.load(std::memory_order_seq_cst)) {
+        unpark();
+    }
+}
+
+uint32_t CarMailbox::take() {
+    return commands.exchange(0, std::memory_order_acquire);
+}
+
+uint32_t CarMailbox::waitUntil(std::chrono::steady_clock::time_point deadline) {
+    uint32_t posted = take();
+    while (posted == 0 && std::chrono::steady_clock::now() < deadline) {
+        park(&deadline);
+        posted = take();
+    }
+    return posted;
+}
+
+uint32_t CarMailbox::wait() {
+    uint32_t posted = take();
+    while (posted == 0) {
+        park(nullptr);
+        posted = take();
+    }
+    return posted;
+}
+
+uint64_t CarMailbox::getParkCount() const {
+    return parkCount.load(std::memory_order_relaxed);
+}
+
+#ifdef __linux__
+
+void CarMailbox::park(const std::chrono::steady_clock::time_point* deadline) {
+    parked.store(true, std::memory_order_seq_cst);
+    
+    if (commands.load(std::memory_order_seq_cst) == 0) {
+        struct timespec timeout;
+        struct timespec* timeoutPtr = nullptr;
+        if (deadline) {
+            auto remaining = *deadline - std::chrono::steady_clock::now();
+            if (remaining <= std::chrono::steady_clock::duration::zero()) {
+                parked.store(false, std::memory_order_relaxed);
+                return;
+            }
+            auto seconds = std::chrono::duration_cast<std::chrono::seconds>(remaining);
+            timeout.tv_sec = static_cast<time_t>(seconds.count());
+            timeout.tv_nsec = static_cast<long>(std::chrono::duration_cast<std::chrono::nanoseconds>(remaining - seconds).count());
+            timeoutPtr = &timeout;
+        }
+        
+        // The kernel re-checks the word, so a post since the load above
+        // makes this return at once
+        parkCount.fetch_add(1, std::memory_order_relaxed);
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&commands), FUTEX_WAIT_PRIVATE, 0, timeoutPtr, nullptr, 0);
+    }
+    
+    parked.store(false, std::memory_order_relaxed);
+}
+
+void CarMailbox::unpark() {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&commands), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+#else
+
+void CarMailbox::park(const std::chrono::steady_clock::time_point* deadline) {
+    std::unique_lock<ProfiledMutex> lock(parkMutex);
+    parked.store(true, std::memory_order_seq_cst);
+    
+    auto posted = [this] { return commands.load(std::memory_order_seq_cst) != 0; };
+    if (!posted()) {
+        parkCount.fetch_add(1, std::memory_order_relaxed);
+        if (deadline) {
+            parkCV.wait_until(lock, *deadline, posted);
+        } else {
+            parkCV.wait(lock, posted);
+        }
+    }
+    
+    parked.store(false, std::memory_order_relaxed);
+}
+
+void CarMailbox::unpark() {
+    std::lock_guard<ProfiledMutex> lock(parkMutex);
+    parkCV.notify_one();
+}
+
+#endif
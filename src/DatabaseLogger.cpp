@@ -1,21 +1,17 @@
 #include "DatabaseLogger.h"
+#include "EnumStrings.h"
+#include "Trace.h"
 #include <iostream>
 #include <chrono>
 #include <ctime>
 #include <iomanip>
 #include <sstream>
 #include <fstream>
-
-#ifndef ELEVATOR_TESTING
-#include <pqxx/pqxx>
-#endif
+#include <algorithm>
+#include <cstdio>
 
 DatabaseLogger::DatabaseLogger(const std::string& connString)
-    : connected(false)
-#ifndef ELEVATOR_TESTING
-    , conn(nullptr)
-#endif
-{
+    : connected(false), counters{}, connecting(false), hasConnected(false), spillFileEvents(0), conn(nullptr) {
     // Use environment variables if available, otherwise use the provided connection string
     std::string host = std::getenv("DB_HOST") ? std::getenv("DB_HOST") : "localhost";
     std::string port = std::getenv("DB_PORT") ? std::getenv("DB_PORT") : "5432";
@@ -37,11 +33,7 @@ DatabaseLogger::DatabaseLogger(const std::string& connString)
 
 // Additional constructor for testing
 DatabaseLogger::DatabaseLogger(bool connectToDb)
-    : connected(false)
-#ifndef ELEVATOR_TESTING
-    , conn(nullptr)
-#endif
-{
+    : connected(false), counters{}, connecting(false), hasConnected(false), spillFileEvents(0), conn(nullptr) {
     if (connectToDb) {
         std::string host = std::getenv("DB_HOST") ? std::getenv("DB_HOST") : "localhost";
         std::string port = std::getenv("DB_PORT") ? std::getenv("DB_PORT") : "5432";
@@ -62,37 +54,93 @@ DatabaseLogger::~DatabaseLogger() {
 }
 
 bool DatabaseLogger::connect() {
-#ifndef ELEVATOR_TESTING
+    // Held through the replay, so live writes queue behind the backlog
+    std::lock_guard<ProfiledMutex> lock(dbMutex);
+    
     try {
-        // Create a new connection
-        conn = std::make_unique<pqxx::connection>(connectionString);
+        // Bound each attempt so a dead host costs seconds, not a TCP timeout
+        std::string options = connectionString;
+        if (options.find("connect_timeout") == std::string::npos && options.find("://") == std::string::npos) {
+            options += " connect_timeout=5";
+        }
         
-        if (conn && conn->is_open()) {
-            std::cout << "Connected to PostgreSQL database: " 
-                      << conn->dbname() << " as " << conn->username() << std::endl;
-            
-            // Initialize database tables
-            initializeDatabase();
-            
-            connected = true;
-            return true;
+        conn = openDatabaseConnection(options);
+        if (!conn->isOpen()) {
+            conn.reset();
+            return false;
         }
+        conn->createSchema();
+        
+        std::cout << "Connected to PostgreSQL database: " << conn->describe() << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "Database connection error: " << e.what() << std::endl;
-        conn = nullptr;
+        conn.reset();
+        return false;
     }
     
-    return false;
-#else
-    // Mock implementation for testing
-    connected = true;
-    return true;
-#endif
+    return replayBufferedEvents();
+}
+
+void DatabaseLogger::connectAsync() {
+    if (connectThread.joinable()) {
+        return;
+    }
+    
+    connecting = true;
+    connectThread = std::thread(&DatabaseLogger::connectionLoop, this);
+}
+
+void DatabaseLogger::connectionLoop() {
+    TRACE_THREAD_NAME("db-connect");
+    
+    auto delay = INITIAL_RETRY_DELAY;
+    std::unique_lock<ProfiledMutex> lock(connectMutex);
+    while (connecting) {
+        if (connected) {
+            // Sleep until an operation reports the connection lost
+            connectCV.wait(lock, [this] { return !connecting || !connected; });
+            delay = INITIAL_RETRY_DELAY;
+            continue;
+        }
+        
+        lock.unlock();
+        bool succeeded = connect();
+        lock.lock();
+        
+        if (!succeeded) {
+            connectCV.wait_for(lock, delay, [this] { return !connecting; });
+            delay = std::min(delay * 2, MAX_RETRY_DELAY);
+        }
+    }
+}
+
+void DatabaseLogger::connectionLost() {
+    {
+        std::lock_guard<ProfiledMutex> lock(bufferMutex);
+        if (!connected) {
+            return;
+        }
+        connected = false;
+    }
+    
+    std::cerr << "Lost database connection; buffering events until it is back" << std::endl;
+    
+    std::lock_guard<ProfiledMutex> lock(connectMutex);
+    connectCV.notify_all();
 }
 
 void DatabaseLogger::disconnect() {
-#ifndef ELEVATOR_TESTING
-    std::lock_guard<std::mutex> lock(dbMutex);
+    // Stop reconnecting, abandoning any pending attempt
+    {
+        std::lock_guard<ProfiledMutex> lock(connectMutex);
+        connecting = false;
+        connectCV.notify_all();
+    }
+    if (connectThread.joinable()) {
+        connectThread.join();
+    }
+    
+    std::lock_guard<ProfiledMutex> lock(dbMutex);
     
     if (conn) {
         try {
@@ -103,58 +151,171 @@ void DatabaseLogger::disconnect() {
         }
     }
     
+    // Keep whatever is still buffered for the next run
+    std::lock_guard<ProfiledMutex> bufferLock(bufferMutex);
     connected = false;
-#else
-    // Mock implementation for testing
-    connected = false;
-#endif
+    if (!bufferedEvents.empty()) {
+        spillToDisk();
+    }
 }
 
 bool DatabaseLogger::isConnected() const {
     return connected;
 }
 
-#ifndef ELEVATOR_TESTING
-void DatabaseLogger::initializeDatabase() {
-    try {
-        std::lock_guard<std::mutex> lock(dbMutex);
-        
-        if (!conn || !conn->is_open()) {
-            return;
+void DatabaseLogger::open() {
+    connectAsync();
+}
+
+void DatabaseLogger::close() {
+    disconnect();
+}
+
+void DatabaseLogger::setSpillFile(const std::string& path) {
+    std::lock_guard<ProfiledMutex> lock(bufferMutex);
+    spillPath = path;
+    
+    // Events left over from an earlier run are replayed with the rest
+    spillFileEvents = 0;
+    std::ifstream in(spillPath);
+    std::string line;
+    while (std::getline(in, line)) {
+        spillFileEvents++;
+    }
+}
+
+bool DatabaseLogger::bufferEvent(LogEventType eventType, int elevatorId, int fromFloor, int toFloor) {
+    std::lock_guard<ProfiledMutex> lock(bufferMutex);
+    
+    // The connection came up since the caller checked; write directly
+    if (connected) {
+        return false;
+    }
+    
+    counters.spilled++;
+    if (bufferedEvents.size() >= MAX_BUFFERED_EVENTS && !spillToDisk()) {
+        bufferedEvents.pop_front();
+        counters.dropped++;
+    }
+    bufferedEvents.push_back({eventType, elevatorId, fromFloor, toFloor, std::chrono::system_clock::now()});
+    return true;
+}
+
+bool DatabaseLogger::spillToDisk() {
+    if (spillPath.empty() || spillFileEvents + bufferedEvents.size() > MAX_SPILLED_EVENTS) {
+        return false;
+    }
+    
+    // One line per event: epoch milliseconds, type name, car, from, to
+    std::ofstream out(spillPath, std::ios::app);
+    for (const auto& event : bufferedEvents) {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(event.time.time_since_epoch()).count();
+        out << ms << ' ' << toString(event.eventType) << ' ' << event.elevatorId << ' '
+            << event.fromFloor << ' ' << event.toFloor << '\n';
+    }
+    out.flush();
+    if (!out) {
+        std::cerr << "Error spilling events to " << spillPath << std::endl;
+        return false;
+    }
+    
+    spillFileEvents += bufferedEvents.size();
+    bufferedEvents.clear();
+    return true;
+}
+
+std::deque<DatabaseLogger::BufferedEvent> DatabaseLogger::readSpillFile() {
+    std::deque<BufferedEvent> events;
+    std::ifstream in(spillPath);
+    long long ms;
+    std::string name;
+    int elevatorId, fromFloor, toFloor;
+    while (in >> ms >> name >> elevatorId >> fromFloor >> toFloor) {
+        auto eventType = parseLogEventType(name);
+        if (!eventType) {
+            counters.dropped++;
+            continue;
         }
+        auto time = std::chrono::system_clock::time_point(std::chrono::milliseconds(ms));
+        events.push_back({*eventType, elevatorId, fromFloor, toFloor, time});
+    }
+    return events;
+}
+
+bool DatabaseLogger::replayBufferedEvents() {
+    // Going live and taking the backlog happen under one lock, so no event
+    // can land in the buffer after it has been drained. Spilled events are
+    // older than the ones in memory.
+    std::deque<BufferedEvent> backlog;
+    size_t fromDisk = 0;
+    {
+        std::lock_guard<ProfiledMutex> lock(bufferMutex);
+        if (spillFileEvents > 0) {
+            backlog = readSpillFile();
+            fromDisk = backlog.size();
+        }
+        backlog.insert(backlog.end(), bufferedEvents.begin(), bufferedEvents.end());
+        bufferedEvents.clear();
+        connected = true;
+        if (hasConnected) {
+            counters.reconnects++;
+        }
+        hasConnected = true;
+    }
+    
+    if (writeEvents(backlog)) {
+        std::lock_guard<ProfiledMutex> lock(bufferMutex);
+        counters.replayed += backlog.size();
+        if (fromDisk > 0 || spillFileEvents > 0) {
+            std::remove(spillPath.c_str());
+            spillFileEvents = 0;
+        }
+        return true;
+    }
+    
+    // Put the in-memory part back in front of anything buffered since; the
+    // spill file is still intact
+    std::lock_guard<ProfiledMutex> lock(bufferMutex);
+    connected = false;
+    bufferedEvents.insert(bufferedEvents.begin(), backlog.begin() + fromDisk, backlog.end());
+    while (bufferedEvents.size() > MAX_BUFFERED_EVENTS) {
+        bufferedEvents.pop_front();
+        counters.dropped++;
+    }
+    conn.reset();
+    return false;
+}
+
+bool DatabaseLogger::writeEvents(const std::deque<BufferedEvent>& events) {
+    if (events.empty()) {
+        return true;
+    }
+    
+    try {
+        auto writeStart = std::chrono::steady_clock::now();
         
-        // Create a transaction
-        pqxx::work txn(*conn);
-        
-        // Check if tables exist and create them if they don't
-        txn.exec(
-            "CREATE TABLE IF NOT EXISTS elevators ("
-            "   id INTEGER PRIMARY KEY,"
-            "   current_floor INTEGER NOT NULL,"
-            "   destination_floor INTEGER NOT NULL,"
-            "   direction INTEGER NOT NULL,"
-            "   status INTEGER NOT NULL,"
-            "   updated_at TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP"
-            ");"
-        );
-        
-        txn.exec(
-            "CREATE TABLE IF NOT EXISTS elevator_logs ("
-            "   id SERIAL PRIMARY KEY,"
-            "   timestamp TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP,"
-            "   event_type VARCHAR(50) NOT NULL,"
-            "   elevator_id INTEGER,"
-            "   from_floor INTEGER,"
-            "   to_floor INTEGER"
-            ");"
-        );
+        // One transaction for the whole backlog, keeping each event's original time
+        conn->insertLogs(events);
+        writeLatency.record(std::chrono::steady_clock::now() - writeStart);
         
-        // Commit the transaction
-        txn.commit();
+        std::cout << "Replayed " << events.size() << " events buffered while the database was offline" << std::endl;
         
     } catch (const std::exception& e) {
-        std::cerr << "Error initializing database: " << e.what() << std::endl;
+        std::cerr << "Error replaying buffered events to database: " << e.what() << std::endl;
+        return false;
     }
+    
+    return true;
+}
+
+size_t DatabaseLogger::getBufferedEventCount() const {
+    std::lock_guard<ProfiledMutex> lock(bufferMutex);
+    return bufferedEvents.size() + spillFileEvents;
+}
+
+DatabaseLogger::EventCounters DatabaseLogger::getEventCounters() const {
+    std::lock_guard<ProfiledMutex> lock(bufferMutex);
+    return counters;
 }
 
 std::string DatabaseLogger::getCurrentTimestamp() const {
@@ -165,49 +326,31 @@ std::string DatabaseLogger::getCurrentTimestamp() const {
     ss << std::put_time(std::localtime(&now_c), "%Y-%m-%d %H:%M:%S");
     return ss.str();
 }
-#endif
 
 void DatabaseLogger::logEvent(LogEventType eventType, int elevatorId, int fromFloor, int toFloor) {
-#ifndef ELEVATOR_TESTING
-    if (!connected || !conn) {
+    TRACE_SCOPE("DatabaseLogger::logEvent");
+    
+    if (!connected && bufferEvent(eventType, elevatorId, fromFloor, toFloor)) {
         return;
     }
     
-    // Map event type to string
-    std::string eventTypeStr;
-    switch (eventType) {
-        case LogEventType::CALL_REQUEST: eventTypeStr = "CALL_REQUEST"; break;
-        case LogEventType::ELEVATOR_DISPATCHED: eventTypeStr = "ELEVATOR_DISPATCHED"; break;
-        case LogEventType::ELEVATOR_ARRIVED: eventTypeStr = "ELEVATOR_ARRIVED"; break;
-        case LogEventType::DOOR_OPENED: eventTypeStr = "DOOR_OPENED"; break;
-        case LogEventType::DOOR_CLOSED: eventTypeStr = "DOOR_CLOSED"; break;
-        case LogEventType::EMERGENCY_STOP: eventTypeStr = "EMERGENCY_STOP"; break;
-        case LogEventType::EMERGENCY_RELEASED: eventTypeStr = "EMERGENCY_RELEASED"; break;
-        case LogEventType::SYSTEM_STARTED: eventTypeStr = "SYSTEM_STARTED"; break;
-        case LogEventType::SYSTEM_STOPPED: eventTypeStr = "SYSTEM_STOPPED"; break;
-        case LogEventType::SYNC_EVENT: eventTypeStr = "SYNC_EVENT"; break;
-        default: eventTypeStr = "UNKNOWN"; break;
-    }
+    // Map event type to its table name (no allocation)
+    std::string_view eventTypeStr = toString(eventType);
     
     try {
-        std::lock_guard<std::mutex> lock(dbMutex);
+        std::unique_lock<ProfiledMutex> lock(dbMutex);
         
-        if (!conn || !conn->is_open()) {
+        if (!conn || !conn->isOpen()) {
+            lock.unlock();
+            connectionLost();
+            bufferEvent(eventType, elevatorId, fromFloor, toFloor);
             return;
         }
         
-        // Create a transaction
-        pqxx::work txn(*conn);
-        
-        // Insert log record
-        txn.exec_params(
-            "INSERT INTO elevator_logs (event_type, elevator_id, from_floor, to_floor) "
-            "VALUES ($1, $2, $3, $4)",
-            eventTypeStr, elevatorId, fromFloor, toFloor
-        );
+        auto writeStart = std::chrono::steady_clock::now();
         
-        // Commit the transaction
-        txn.commit();
+        conn->insertLog(eventType, elevatorId, fromFloor, toFloor);
+        writeLatency.record(std::chrono::steady_clock::now() - writeStart);
         
         // Also log to console for debugging
         std::cout << getCurrentTimestamp() << " - " << eventTypeStr
@@ -215,134 +358,98 @@ void DatabaseLogger::logEvent(LogEventType eventType, int elevatorId, int fromFl
                   << " - From: " << fromFloor
                   << " - To: " << toFloor << std::endl;
         
+    } catch (const DatabaseConnection::Broken&) {
+        connectionLost();
+        bufferEvent(eventType, elevatorId, fromFloor, toFloor);
     } catch (const std::exception& e) {
         std::cerr << "Error logging event to database: " << e.what() << std::endl;
     }
-#endif
-}
-
-void DatabaseLogger::logSystemEvent(LogEventType eventType) {
-    logEvent(eventType, -1, -1, -1);
 }
 
 void DatabaseLogger::syncElevatorState(int elevatorId, int currentFloor, int destFloor, int direction, int status) {
-#ifndef ELEVATOR_TESTING
-    if (!connected || !conn) {
+    TRACE_SCOPE("DatabaseLogger::syncElevatorState");
+    
+    if (!connected) {
         return;
     }
     
     try {
-        std::lock_guard<std::mutex> lock(dbMutex);
+        std::unique_lock<ProfiledMutex> lock(dbMutex);
         
-        if (!conn || !conn->is_open()) {
+        if (!conn || !conn->isOpen()) {
+            lock.unlock();
+            connectionLost();
             return;
         }
         
-        // Create a transaction
-        pqxx::work txn(*conn);
-        
-        // Insert or update elevator state
-        txn.exec_params(
-            "INSERT INTO elevators (id, current_floor, destination_floor, direction, status, updated_at) "
-            "VALUES ($1, $2, $3, $4, $5, CURRENT_TIMESTAMP) "
-            "ON CONFLICT (id) DO UPDATE SET "
-            "current_floor = $2, destination_floor = $3, direction = $4, status = $5, "
-            "updated_at = CURRENT_TIMESTAMP",
-            elevatorId, currentFloor, destFloor, direction, status
-        );
+        auto writeStart = std::chrono::steady_clock::now();
         
-        // Commit the transaction
-        txn.commit();
+        conn->upsertElevator(elevatorId, currentFloor, destFloor, direction, status);
+        writeLatency.record(std::chrono::steady_clock::now() - writeStart);
         
+    } catch (const DatabaseConnection::Broken&) {
+        connectionLost();
     } catch (const std::exception& e) {
         std::cerr << "Error syncing elevator state to database: " << e.what() << std::endl;
     }
-#endif
 }
 
-std::vector<std::tuple<int, int, int, Direction, ElevatorStatus>> DatabaseLogger::getElevatorStates() {
-    std::vector<std::tuple<int, int, int, Direction, ElevatorStatus>> states;
+std::vector<EventSink::ElevatorState> DatabaseLogger::getElevatorStates() {
+    TRACE_SCOPE("DatabaseLogger::getElevatorStates");
     
-#ifndef ELEVATOR_TESTING
-    if (!connected || !conn) {
+    std::vector<ElevatorState> states;
+    
+    if (!connected) {
         return states;
     }
     
     try {
-        std::lock_guard<std::mutex> lock(dbMutex);
+        std::unique_lock<ProfiledMutex> lock(dbMutex);
         
-        if (!conn || !conn->is_open()) {
+        if (!conn || !conn->isOpen()) {
+            lock.unlock();
+            connectionLost();
             return states;
         }
         
-        // Create a transaction
-        pqxx::work txn(*conn);
-        
-        // Query elevator states
-        pqxx::result result = txn.exec(
-            "SELECT id, current_floor, destination_floor, direction, status FROM elevators "
-            "ORDER BY id"
-        );
-        
-        // Iterate through results
-        for (const auto& row : result) {
-            int id = row[0].as<int>();
-            int currentFloor = row[1].as<int>();
-            int destFloor = row[2].as<int>();
-            Direction direction = static_cast<Direction>(row[3].as<int>());
-            ElevatorStatus status = static_cast<ElevatorStatus>(row[4].as<int>());
-            
-            states.emplace_back(id, currentFloor, destFloor, direction, status);
-        }
-        
+        states = conn->selectElevators();
+    } catch (const DatabaseConnection::Broken&) {
+        connectionLost();
     } catch (const std::exception& e) {
         std::cerr << "Error retrieving elevator states from database: " << e.what() << std::endl;
     }
-#endif
     
     return states;
 }
 
-std::vector<std::tuple<std::string, std::string, int, int, int>> DatabaseLogger::getRecentLogs(int limit) {
-    std::vector<std::tuple<std::string, std::string, int, int, int>> logs;
+std::vector<EventSink::LogRow> DatabaseLogger::getRecentLogs(int limit, std::chrono::system_clock::time_point before) {
+    TRACE_SCOPE("DatabaseLogger::getRecentLogs");
+    
+    std::vector<LogRow> logs;
     
-#ifndef ELEVATOR_TESTING
-    if (!connected || !conn) {
+    if (!connected) {
         return logs;
     }
     
     try {
-        std::lock_guard<std::mutex> lock(dbMutex);
+        std::unique_lock<ProfiledMutex> lock(dbMutex);
         
-        if (!conn || !conn->is_open()) {
+        if (!conn || !conn->isOpen()) {
+            lock.unlock();
+            connectionLost();
             return logs;
         }
         
-        // Create a transaction
-        pqxx::work txn(*conn);
-        
-        // Query recent logs
-        pqxx::result result = txn.exec_params(
-            "SELECT timestamp, event_type, elevator_id, from_floor, to_floor FROM elevator_logs "
-            "ORDER BY timestamp DESC LIMIT $1",
-            limit
-        );
-        
-        // Iterate through results
-        for (const auto& row : result) {
-            std::string timestamp = row[0].as<std::string>();
-            std::string eventType = row[1].as<std::string>();
-            int elevatorId = row[2].as<int>();
-            int fromFloor = row[3].as<int>();
-            int toFloor = row[4].as<int>();
-            
-            logs.emplace_back(timestamp, eventType, elevatorId, fromFloor, toFloor);
-        }
-        
+        logs = conn->selectRecentLogs(limit, before);
+    } catch (const DatabaseConnection::Broken&) {
+        connectionLost();
     } catch (const std::exception& e) {
         std::cerr << "Error retrieving logs from database: " << e.what() << std::endl;
     }
-#endif
     
     return logs;
-}
\ No newline at end of file
+}
+
+LatencyHistogram::Snapshot DatabaseLogger::getWriteLatency() const {
+    return writeLatency.snapshot();
+}
@@ -1,9 +1,9 @@
 #include "DemoRunner.h"
+#include "SimRandom.h"
 #include <iostream>
-#include <random>
 
-DemoRunner::DemoRunner(ElevatorController& controller)
-    : controller(controller), running(false) {
+DemoRunner::DemoRunner(ElevatorController& controller, uint64_t seed)
+    : controller(controller), seed(seed), running(false) {
     initializeDemoSteps();
 }
 
@@ -73,9 +73,8 @@ void DemoRunner::initializeDemoSteps() {
     int numFloors = controller.getNumFloors();
     
     // Create a random number generator for more varied demonstrations
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> floorDist(1, numFloors);
+    SimRandom gen(seed);
+    auto floorDist = [numFloors](SimRandom& random) { return random.uniformInt(1, numFloors); };
     
     // PHASE 1: Initial demonstration of individual elevator movements
     // Step 1: Call elevator to floor 3 going up
@@ -180,8 +179,7 @@ void DemoRunner::initializeDemoSteps() {
             for (const auto& [id, currentFloor, destFloor, direction, status] : statuses) {
                 if (currentFloor == 1) {
                     // Distribute passengers to different upper floors
-                    std::uniform_int_distribution<> upperFloorDist(numFloors/2, numFloors);
-                    int targetFloor = upperFloorDist(gen);
+                    int targetFloor = gen.uniformInt(numFloors/2, numFloors);
                     controller.addRequest(1, targetFloor, Direction::UP);
                     std::cout << "  - Passenger in elevator #" << id << " going to floor " << targetFloor << std::endl;
                 }
@@ -196,8 +194,7 @@ void DemoRunner::initializeDemoSteps() {
         [this, numElevators, numFloors, floorDist, gen]() mutable {
             // Multiple people calling elevators from upper floors
             for (int i = 0; i < numElevators * 2; i++) {
-                std::uniform_int_distribution<> upperFloorDist(numFloors/2, numFloors);
-                int fromFloor = upperFloorDist(gen);
+                int fromFloor = gen.uniformInt(numFloors/2, numFloors);
                 controller.addRequest(fromFloor, 0, Direction::DOWN);
                 std::cout << "  - Calling elevator to floor " << fromFloor << " (going down)" << std::endl;
                 std::this_thread::sleep_for(std::chrono::milliseconds(500)); // Stagger requests
@@ -238,7 +235,7 @@ void DemoRunner::initializeDemoSteps() {
                 std::cout << "  - Request " << (i+1) << ": Calling elevator to floor " << fromFloor << std::endl;
                 
                 // Wait a short random time between requests
-                std::this_thread::sleep_for(std::chrono::milliseconds(300 + (gen() % 700)));
+                std::this_thread::sleep_for(std::chrono::milliseconds(300 + gen.uniformInt(0, 699)));
             }
         },
         30000  // Wait 30 seconds for the system to handle all these requests
@@ -7,11 +7,13 @@
 #include <thread>
 #include <functional>
 #include <atomic>
+#include <cstdint>
 
 // A class to run automated demos of the elevator system
 class DemoRunner {
 public:
-    DemoRunner(ElevatorController& controller);
+    // Every random choice in the demo derives from seed
+    DemoRunner(ElevatorController& controller, uint64_t seed);
     ~DemoRunner();
     
     // Start the demo
@@ -34,6 +36,7 @@ private:
     };
     
     ElevatorController& controller;
+    uint64_t seed;
     std::vector<DemoStep> demoSteps;
     std::thread demoThread;
     std::atomic<bool> running;
@@ -1,7 +1,19 @@
 #include "Elevator.h"
+#include "EventBus.h"
+#include "Trace.h"
 #include <thread>
 #include <iostream>
 #include <chrono>
+#include <algorithm>
+#include <cmath>
+
+// Passenger ids are unique across every car
+static std::atomic<uint64_t> nextPassengerId{0};
+
+// Where the car is once a trip is served; call requests end at the pickup
+static int tripEndFloor(const Request& request) {
+    return request.toFloor != 0 ? request.toFloor : request.fromFloor;
+}
 
 Elevator::Elevator(int elevatorId, int startFloor, int floors)
     : id(elevatorId),
@@ -11,7 +23,23 @@ Elevator::Elevator(int elevatorId, int startFloor, int floors)
       status(ElevatorStatus::IDLE),
       emergencyStop(false),
       running(false),
-      numFloors(floors) {
+      numFloors(floors),
+      servedFloors(floors + 1, true),
+      tripsCompleted(0),
+      floorsTravelled(0),
+      doorCycles(0),
+      passengersDelivered(0),
+      capacity(DEFAULT_CAPACITY),
+      load(0),
+      queuedPassengers(0) {
+    // Floors are numbered from 1; every car serves every floor by default
+    servedFloors.reset(0);
+    
+    KinematicConfig kinematics;
+    travelTimes = kinematics.buildTable(numFloors);
+    doorTiming = kinematics.doors;
+    timeScale = kinematics.timeScale;
+    committedEndFloor = startFloor;
 }
 
 Elevator::~Elevator() {
@@ -33,7 +61,7 @@ void Elevator::stop() {
     }
     
     running = false;
-    requestCV.notify_all();
+    mailbox.post(CarMailbox::SHUTDOWN);
     
     // Wait for the processing thread to finish
     if (processingThread.joinable()) {
@@ -44,106 +72,559 @@ void Elevator::stop() {
 void Elevator::emergencyStopActivate() {
     emergencyStop = true;
     status = ElevatorStatus::EMERGENCY;
-    requestCV.notify_all();
+    mailbox.post(CarMailbox::EMERGENCY);
 }
 
 void Elevator::emergencyStopRelease() {
     emergencyStop = false;
     status = ElevatorStatus::IDLE;
+    // Trips queued before the emergency resume without waiting for a new one
+    mailbox.post(CarMailbox::RELEASE);
 }
 
 bool Elevator::addRequest(const Request& request) {
+    TRACE_SCOPE("Elevator::addRequest");
+    
     if (emergencyStop) {
         return false;
     }
     
+    if (!servesFloor(request.fromFloor) || (request.toFloor != 0 && !servesFloor(request.toFloor))) {
+        return false;
+    }
+    
+    {
+        std::unique_lock<ProfiledMutex> lock(requestMutex);
+        enqueueTrip(request);
+    }
+    queuedPassengers.fetch_add(request.passengers, std::memory_order_relaxed);
+    
+    mailbox.post(CarMailbox::WORK);
+    return true;
+}
+
+void Elevator::enqueueTrip(const Request& request) {
+    // A new trip starts where committed work ends, or here if there is none
+    int startFloor = (tripInProgress || !requests.empty()) ? committedEndFloor : currentFloor.load();
+    auto plannedTime = plannedTripTime(startFloor, request);
+    
+    requests.push_back(QueuedTrip{request, plannedTime});
+    queuedWork += plannedTime;
+    committedEndFloor = tripEndFloor(request);
+}
+
+void Elevator::replanQueue() {
+    int floor = tripInProgress ? tripEndFloor(activeTrip) : currentFloor.load();
+    queuedWork = std::chrono::milliseconds(0);
+    for (auto& trip : requests) {
+        trip.plannedTime = plannedTripTime(floor, trip.request);
+        queuedWork += trip.plannedTime;
+        floor = tripEndFloor(trip.request);
+    }
+    committedEndFloor = floor;
+}
+
+std::chrono::milliseconds Elevator::activeTripRemaining() const {
+    // Converted back to simulated time
+    auto now = std::chrono::steady_clock::now();
+    if (!tripInProgress || activeTripDue <= now) {
+        return std::chrono::milliseconds(0);
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>((activeTripDue - now) * timeScale);
+}
+
+std::chrono::milliseconds Elevator::plannedTripTime(int startFloor, const Request& request) const {
+    std::chrono::milliseconds time{0};
+    
+    // Mirrors processRequests: the doors only cycle at the pickup if the car
+    // had to move there
+    if (startFloor != request.fromFloor) {
+        time += travelTimes->travelTime(startFloor, request.fromFloor) + doorTiming.stopTime(request.passengers);
+    }
+    if (request.toFloor != 0) {
+        time += std::chrono::milliseconds(boardingHoldMs.load());
+        time += travelTimes->travelTime(request.fromFloor, request.toFloor) + doorTiming.stopTime(request.passengers);
+    }
+    return time;
+}
+
+bool Elevator::joinQueuedRequest(const Request& request) {
+    if (emergencyStop || request.toFloor == 0) {
+        return false;
+    }
+    
+    auto sameTrip = [&](const Request& trip) {
+        return trip.fromFloor == request.fromFloor && trip.toFloor == request.toFloor &&
+               trip.passengers + request.passengers <= capacity;
+    };
+    
+    {
+        std::lock_guard<ProfiledMutex> lock(requestMutex);
+        
+        // The group keeps the earliest arrival time. A bigger group needs
+        // longer dwells, which pushes back everything committed after it.
+        if (activeTripJoinable && sameTrip(activeTrip)) {
+            auto extraDwell = doorTiming.stopTime(activeTrip.passengers + request.passengers) -
+                              doorTiming.stopTime(activeTrip.passengers);
+            activeTrip.passengers += request.passengers;
+            activeTripDue += toWallTime(extraDwell);
+        } else {
+            auto trip = std::find_if(requests.begin(), requests.end(), [&](const QueuedTrip& queued) {
+                return sameTrip(queued.request);
+            });
+            if (trip == requests.end()) {
+                return false;
+            }
+            auto extraDwell = 2 * (doorTiming.stopTime(trip->request.passengers + request.passengers) -
+                                   doorTiming.stopTime(trip->request.passengers));
+            trip->request.passengers += request.passengers;
+            trip->plannedTime += extraDwell;
+            queuedWork += extraDwell;
+        }
+    }
+    queuedPassengers.fetch_add(request.passengers, std::memory_order_relaxed);
+    
+    return true;
+}
+
+void Elevator::getQueuedCalls(std::vector<QueuedCall>& out) const {
+    out.clear();
+    
+    std::lock_guard<ProfiledMutex> lock(requestMutex);
+    auto elapsed = activeTripRemaining();
+    int floor = tripInProgress ? tripEndFloor(activeTrip) : currentFloor.load();
+    for (const auto& trip : requests) {
+        out.push_back(QueuedCall{trip.request, elapsed + travelTimes->travelTime(floor, trip.request.fromFloor)});
+        elapsed += trip.plannedTime;
+        floor = tripEndFloor(trip.request);
+    }
+}
+
+std::optional<Request> Elevator::withdrawQueuedCall(const Request& call) {
+    std::optional<Request> withdrawn;
+    {
+        std::lock_guard<ProfiledMutex> lock(requestMutex);
+        auto trip = std::find_if(requests.begin(), requests.end(), [&](const QueuedTrip& queued) {
+            return queued.request.fromFloor == call.fromFloor && queued.request.toFloor == call.toFloor &&
+                   queued.request.timestamp == call.timestamp;
+        });
+        if (trip == requests.end()) {
+            return std::nullopt;
+        }
+        
+        // Passengers who joined since the caller looked leave with the trip
+        withdrawn = trip->request;
+        requests.erase(trip);
+        replanQueue();
+    }
+    queuedPassengers.fetch_sub(withdrawn->passengers, std::memory_order_relaxed);
+    
+    return withdrawn;
+}
+
+bool Elevator::park(int floor) {
+    if (emergencyStop || !running || !servesFloor(floor)) {
+        return false;
+    }
+    
     {
-        std::lock_guard<std::mutex> lock(requestMutex);
-        requests.push(request);
+        // Checked and set together, so a trip queued meanwhile either fails
+        // this check or clears the floor when the car takes it
+        std::lock_guard<ProfiledMutex> lock(requestMutex);
+        if (tripInProgress || !requests.empty()) {
+            return false;
+        }
+        parkingFloor = floor;
+    }
+    
+    mailbox.post(CarMailbox::PARK);
+    return true;
+}
+
+bool Elevator::hasQueuedTrips() const {
+    std::lock_guard<ProfiledMutex> lock(requestMutex);
+    return !requests.empty();
+}
+
+void Elevator::setBoardingHold(std::chrono::milliseconds hold) {
+    boardingHoldMs = static_cast<int>(hold.count());
+}
+
+bool Elevator::setServedFloors(const Bitmask& floors) {
+    if (running || floors.size() != servedFloors.size() || floors.test(0) || !floors.any()) {
+        return false;
+    }
+    
+    servedFloors = floors;
+    
+    if (!servesFloor(currentFloor)) {
+        currentFloor = static_cast<int>(servedFloors.first());
+        destinationFloor = currentFloor.load();
+        committedEndFloor = currentFloor;
+    }
+    
+    return true;
+}
+
+const Bitmask& Elevator::getServedFloors() const {
+    return servedFloors;
+}
+
+bool Elevator::servesFloor(int floor) const {
+    return floor > 0 && servedFloors.test(static_cast<size_t>(floor));
+}
+
+bool Elevator::setCapacity(int passengers) {
+    if (running || passengers < 1) {
+        return false;
+    }
+    capacity = passengers;
+    return true;
+}
+
+bool Elevator::setKinematics(const KinematicConfig& config, std::shared_ptr<const TravelTimeTable> table) {
+    if (running || !table || table->getNumFloors() != numFloors || config.timeScale <= 0.0) {
+        return false;
     }
     
-    requestCV.notify_one();
+    travelTimes = std::move(table);
+    doorTiming = config.doors;
+    timeScale = config.timeScale;
     return true;
 }
 
+const TravelTimeTable& Elevator::getTravelTimes() const {
+    return *travelTimes;
+}
+
+const DoorTiming& Elevator::getDoorTiming() const {
+    return doorTiming;
+}
+
+void Elevator::setEventBus(EventBus* bus) {
+    if (!running) {
+        eventBus = bus;
+    }
+}
+
+std::chrono::nanoseconds Elevator::toWallTime(std::chrono::milliseconds simulated) const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double, std::milli>(simulated.count() / timeScale));
+}
+
+int Elevator::getCapacity() const {
+    return capacity;
+}
+
+int Elevator::getLoad() const {
+    return load;
+}
+
+int Elevator::getAvailableCapacity() const {
+    return capacity - load - queuedPassengers.load(std::memory_order_relaxed);
+}
+
 void Elevator::processRequests() {
+    TRACE_THREAD_NAME("elevator-" + std::to_string(id));
+    
     while (running) {
         Request currentRequest{0, 0, Direction::IDLE};
         bool hasRequest = false;
+        int parkAt = 0;
         
         {
-            std::unique_lock<std::mutex> lock(requestMutex);
-            requestCV.wait(lock, [this] {
-                return !running || emergencyStop || !requests.empty();
-            });
-            
-            if (!running) {
-                break;
-            }
+            std::lock_guard<ProfiledMutex> lock(requestMutex);
             
-            if (emergencyStop) {
-                // Wait until emergency is cleared
-                continue;
-            }
-            
-            if (!requests.empty()) {
-                currentRequest = requests.front();
-                requests.pop();
+            // Queued trips wait out an emergency
+            if (!emergencyStop && !requests.empty()) {
+                currentRequest = requests.front().request;
+                queuedWork -= requests.front().plannedTime;
+                requests.pop_front();
                 hasRequest = true;
+                // A trip supersedes any pending parking run
+                parkingFloor = 0;
+                
+                activeTrip = currentRequest;
+                activeTripJoinable = currentRequest.toFloor != 0;
+                activeTripBoarded = false;
+                
+                // Re-plan from where the car actually is, which differs from
+                // the queued plan after an emergency stop
+                tripInProgress = true;
+                activeTripDue = std::chrono::steady_clock::now() +
+                                toWallTime(plannedTripTime(currentFloor, currentRequest));
+            } else {
+                parkAt = parkingFloor;
+                parkingFloor = 0;
             }
         }
         
         if (hasRequest) {
             // First move to the pickup floor if it's a new request
             if (currentRequest.fromFloor != currentFloor) {
-                moveToFloor(currentRequest.fromFloor);
+                moveToFloor(currentRequest.fromFloor, currentRequest.passengers);
+            }
+            
+            // Hold the doors so keypad entries for the same trip can join
+            int holdMs = boardingHoldMs;
+            if (holdMs > 0 && currentRequest.toFloor != 0 &&
+                currentFloor == currentRequest.fromFloor && !emergencyStop) {
+                status = ElevatorStatus::STOPPED;
+                pauseUntil(std::chrono::steady_clock::now() + std::chrono::milliseconds(holdMs));
+            }
+            
+            {
+                std::lock_guard<ProfiledMutex> lock(requestMutex);
+                activeTripJoinable = false;
+                activeTripBoarded = currentFloor == currentRequest.fromFloor;
+                currentRequest.passengers = activeTrip.passengers;
+            }
+            
+            if (currentFloor == currentRequest.fromFloor) {
+                boardPassengers(currentRequest);
+            } else {
+                // Interrupted before the pickup; the waiting passengers give up
+                queuedPassengers.fetch_sub(currentRequest.passengers, std::memory_order_relaxed);
             }
             
             // Only move to the destination floor if it's not 0 (which indicates a call request)
             if (currentRequest.toFloor != 0) {
-                moveToFloor(currentRequest.toFloor);
+                int alighting = static_cast<int>(std::count_if(onboard.begin(), onboard.end(),
+                    [&](const Passenger& passenger) { return passenger.destinationFloor == currentRequest.toFloor; }));
+                moveToFloor(currentRequest.toFloor, alighting);
+            }
+            
+            alightPassengers();
+            
+            {
+                std::lock_guard<ProfiledMutex> lock(requestMutex);
+                tripInProgress = false;
             }
         } else {
+            // Trips always come first; a parking run only starts with none queued
+            if (parkAt != 0 && !emergencyStop) {
+                reposition(parkAt);
+                continue;
+            }
+            
             // No requests, set to idle
             direction = Direction::IDLE;
-            status = ElevatorStatus::IDLE;
+            if (!emergencyStop) {
+                status = ElevatorStatus::IDLE;
+            }
+            
+            // Park until a trip is queued, the emergency is released or the
+            // car is stopped; anything posted since the check above returns at once
+            if (mailbox.wait() & CarMailbox::SHUTDOWN) {
+                break;
+            }
         }
     }
 }
 
-void Elevator::moveToFloor(int floor) {
-    if (floor == currentFloor) {
+bool Elevator::pauseUntil(std::chrono::steady_clock::time_point deadline) {
+    while (running && !emergencyStop) {
+        // New trips and releases are picked up once this step is done
+        if (mailbox.waitUntil(deadline) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Elevator::moveToFloor(int floor, int passengersExchanged) {
+    if (floor == currentFloor || emergencyStop || !running) {
+        return;
+    }
+    
+    const int startFloor = currentFloor;
+    if (!runToFloor(floor, false)) {
         return;
     }
     
+    // Doors stay open longer the more people get on or off
+    status = ElevatorStatus::STOPPED;
+    tripsCompleted.fetch_add(1, std::memory_order_relaxed);
+    doorCycles.fetch_add(1, std::memory_order_relaxed);
+    if (eventBus) {
+        eventBus->publish(LogEventType::ELEVATOR_ARRIVED, id, startFloor, floor);
+        eventBus->publish(LogEventType::DOOR_OPENED, id, floor, floor);
+    }
+    pauseUntil(std::chrono::steady_clock::now() + toWallTime(doorTiming.stopTime(passengersExchanged)));
+    if (eventBus) {
+        eventBus->publish(LogEventType::DOOR_CLOSED, id, floor, floor);
+    }
+    
+    // Reset direction if we're at the destination
+    direction = Direction::IDLE;
+    if (!emergencyStop) {
+        status = ElevatorStatus::IDLE;
+    }
+}
+
+bool Elevator::runToFloor(int floor, bool yieldToTrips) {
     // Set direction and status
     direction = (floor > currentFloor) ? Direction::UP : Direction::DOWN;
     status = ElevatorStatus::MOVING;
     destinationFloor = floor;
+    if (eventBus) {
+        eventBus->publish(LogEventType::ELEVATOR_DEPARTED, id, currentFloor, floor);
+    }
+    
+    // The whole run follows one acceleration profile, so its duration comes
+    // from the table rather than from summing single-floor hops. The floor
+    // indicator advances as the car passes each floor, interpolated by height.
+    const int startFloor = currentFloor;
+    const auto departure = std::chrono::steady_clock::now();
+    const auto runTime = toWallTime(travelTimes->travelTime(startFloor, floor));
+    const double startPosition = travelTimes->floorPosition(startFloor);
+    const double runDistance = std::abs(travelTimes->floorPosition(floor) - startPosition);
     
-    // Simulate movement between floors
-    while (currentFloor != floor && !emergencyStop && running) {
-        // Wait for the time it takes to move between floors
-        std::this_thread::sleep_for(std::chrono::milliseconds(FLOOR_TRAVEL_TIME_MS));
+    while (currentFloor != floor) {
+        if (yieldToTrips && hasQueuedTrips()) {
+            return false;
+        }
         
-        // Move one floor in the current direction
-        if (direction == Direction::UP) {
-            currentFloor++;
-        } else {
-            currentFloor--;
+        int nextFloor = (direction == Direction::UP) ? currentFloor + 1 : currentFloor - 1;
+        double fraction = std::abs(travelTimes->floorPosition(nextFloor) - startPosition) / runDistance;
+        
+        // Each leg is a timed wait on the mailbox, so an emergency stop or
+        // shutdown halts the car between floors instead of at the next one
+        if (!pauseUntil(departure + std::chrono::duration_cast<std::chrono::nanoseconds>(runTime * fraction))) {
+            return false;
         }
         
-        // Check if we've reached the destination
-        if (currentFloor == floor) {
-            // Simulate doors opening and closing
-            status = ElevatorStatus::STOPPED;
-            std::this_thread::sleep_for(std::chrono::milliseconds(DOOR_OPERATION_TIME_MS * 2));
-            
-            // Reset direction if we're at the destination
-            direction = Direction::IDLE;
-            status = ElevatorStatus::IDLE;
+        int previousFloor = currentFloor;
+        currentFloor = nextFloor;
+        floorsTravelled.fetch_add(1, std::memory_order_relaxed);
+        
+        if (currentFloor != floor && eventBus) {
+            eventBus->publish(LogEventType::FLOOR_PASSED, id, previousFloor, currentFloor);
         }
     }
+    
+    return true;
+}
+
+void Elevator::reposition(int floor) {
+    if (floor == currentFloor || !running) {
+        return;
+    }
+    
+    const int startFloor = currentFloor;
+    runToFloor(floor, true);
+    
+    direction = Direction::IDLE;
+    if (emergencyStop || !running) {
+        return;
+    }
+    
+    // Nobody is waiting here yet, so the doors stay shut
+    status = ElevatorStatus::IDLE;
+    if (eventBus && currentFloor != startFloor) {
+        eventBus->publish(LogEventType::ELEVATOR_ARRIVED, id, startFloor, currentFloor);
+    }
+}
+
+void Elevator::boardPassengers(const Request& request) {
+    queuedPassengers.fetch_sub(request.passengers, std::memory_order_relaxed);
+    
+    int boarding = std::min(request.passengers, capacity - load.load());
+    auto now = std::chrono::system_clock::now();
+    for (int i = 0; i < boarding; i++) {
+        onboard.push_back(Passenger{
+            nextPassengerId.fetch_add(1, std::memory_order_relaxed),
+            request.fromFloor,
+            request.toFloor,
+            request.timestamp,
+            now
+        });
+    }
+    load += boarding;
+    
+    // Whoever did not fit waits for this car's next visit
+    if (boarding < request.passengers) {
+        Request leftover = request;
+        leftover.passengers = request.passengers - boarding;
+        {
+            std::lock_guard<ProfiledMutex> lock(requestMutex);
+            enqueueTrip(leftover);
+        }
+        queuedPassengers.fetch_add(leftover.passengers, std::memory_order_relaxed);
+    }
+}
+
+void Elevator::alightPassengers() {
+    int floor = currentFloor;
+    auto arrived = std::partition(onboard.begin(), onboard.end(), [floor](const Passenger& passenger) {
+        return passenger.destinationFloor != floor;
+    });
+    int delivered = static_cast<int>(onboard.end() - arrived);
+    
+    // A trip cut short by an emergency stop evacuates everyone on board
+    int evacuated = 0;
+    if (emergencyStop || !running) {
+        evacuated = static_cast<int>(arrived - onboard.begin());
+        onboard.clear();
+    } else {
+        onboard.erase(arrived, onboard.end());
+    }
+    load -= delivered + evacuated;
+    
+    if (delivered > 0) {
+        passengersDelivered.fetch_add(delivered, std::memory_order_relaxed);
+        
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<ProfiledMutex> lock(requestMutex);
+        recentDeliveries.emplace_back(now, delivered);
+        while (recentDeliveries.front().first < now - HANDLING_CAPACITY_WINDOW) {
+            recentDeliveries.pop_front();
+        }
+    }
+}
+
+std::vector<Request> Elevator::getOutstandingRequests() const {
+    std::lock_guard<ProfiledMutex> lock(requestMutex);
+    
+    std::vector<Request> outstanding;
+    outstanding.reserve(requests.size() + 1);
+    
+    if (tripInProgress && !activeTripBoarded) {
+        outstanding.push_back(activeTrip);
+    } else if (tripInProgress && activeTrip.toFloor != 0 && activeTrip.toFloor != currentFloor) {
+        // Riders are on board: resume from wherever the car is now
+        Request trip = activeTrip;
+        trip.fromFloor = currentFloor;
+        trip.direction = trip.toFloor > trip.fromFloor ? Direction::UP : Direction::DOWN;
+        outstanding.push_back(trip);
+    }
+    
+    for (const auto& queued : requests) {
+        outstanding.push_back(queued.request);
+    }
+    return outstanding;
+}
+
+bool Elevator::restore(int floor, bool emergency, const std::vector<Request>& outstanding) {
+    if (running || !servesFloor(floor)) {
+        return false;
+    }
+    
+    currentFloor = floor;
+    destinationFloor = floor;
+    committedEndFloor = floor;
+    if (emergency) {
+        emergencyStopActivate();
+    }
+    
+    // addRequest refuses work during an emergency, so queue directly
+    std::lock_guard<ProfiledMutex> lock(requestMutex);
+    for (const auto& request : outstanding) {
+        enqueueTrip(request);
+        queuedPassengers.fetch_add(request.passengers, std::memory_order_relaxed);
+    }
+    
+    return true;
 }
 
 int Elevator::getId() const {
@@ -174,6 +655,40 @@ bool Elevator::hasEmergencyStop() const {
     return emergencyStop;
 }
 
+uint64_t Elevator::getTripsCompleted() const {
+    return tripsCompleted.load(std::memory_order_relaxed);
+}
+
+uint64_t Elevator::getFloorsTravelled() const {
+    return floorsTravelled.load(std::memory_order_relaxed);
+}
+
+uint64_t Elevator::getDoorCycles() const {
+    return doorCycles.load(std::memory_order_relaxed);
+}
+
+size_t Elevator::getQueueDepth() const {
+    std::lock_guard<ProfiledMutex> lock(requestMutex);
+    return requests.size();
+}
+
+uint64_t Elevator::getPassengersDelivered() const {
+    return passengersDelivered.load(std::memory_order_relaxed);
+}
+
+int Elevator::getRecentDeliveries() const {
+    auto cutoff = std::chrono::steady_clock::now() - HANDLING_CAPACITY_WINDOW;
+    
+    std::lock_guard<ProfiledMutex> lock(requestMutex);
+    int total = 0;
+    for (const auto& [time, passengers] : recentDeliveries) {
+        if (time >= cutoff) {
+            total += passengers;
+        }
+    }
+    return total;
+}
+
 int Elevator::calculateDistance(int floor) const {
     int distance = std::abs(currentFloor - floor);
     
@@ -187,4 +702,14 @@ int Elevator::calculateDistance(int floor) const {
     }
     
     return distance;
-}
\ No newline at end of file
+}
+
+std::chrono::milliseconds Elevator::estimateTravelTime(int floor) const {
+    std::lock_guard<ProfiledMutex> lock(requestMutex);
+    
+    if (!tripInProgress && requests.empty()) {
+        return travelTimes->travelTime(currentFloor, floor);
+    }
+    
+    return activeTripRemaining() + queuedWork + travelTimes->travelTime(committedEndFloor, floor);
+}
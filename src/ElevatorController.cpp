@@ -1,26 +1,41 @@
 #include "ElevatorController.h"
+#include "DatabaseLogger.h"
+#include "Trace.h"
 #include <algorithm>
 #include <iostream>
 #include <limits>
 #include <chrono>
 #include <thread>
 #include <functional>
+#include <cstring>
 
-ElevatorController::ElevatorController(int numElevators, int numFloors)
-    : numFloors(numFloors), running(false), syncRunning(false) {
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+ElevatorController::ElevatorController(int numElevators, int numFloors, int firstElevatorId,
+                                       std::unique_ptr<EventSink> eventSink)
+    : running(false), eventSink(std::move(eventSink)), sinkRunning(false), numFloors(numFloors), dispatcherCpu(-1),
+      adoptDatabaseElevators(true), dispatchMode(DispatchMode::CONVENTIONAL), groupedRequests(0), reassignCalls(true),
+      reassignedRequests(0), arrivalStats(numFloors), parkIdle(false), parkingMoves(0), syncRunning(false) {
     
-    // Initialize database logger
-    dbLogger = std::make_unique<DatabaseLogger>();
+    if (!this->eventSink) {
+        this->eventSink = std::make_unique<DatabaseLogger>();
+    }
     
-    // Create elevators
+    // Every floor passed would swamp the log; the ring and live subscribers see them
+    sinkSubscription = eventBus.subscribe(EventBus::ALL_EVENTS & ~EventBus::typeBit(LogEventType::FLOOR_PASSED),
+                                          SINK_QUEUE_CAPACITY);
+    
+    // Create elevators, all sharing one travel-time table
+    travelTimes = kinematics.buildTable(numFloors);
     for (int i = 0; i < numElevators; i++) {
-        elevators.push_back(std::make_unique<Elevator>(i, 1, numFloors));
+        ownedCars.push_back(std::make_unique<Elevator>(firstElevatorId + i, 1, numFloors));
+        ownedCars.back()->setKinematics(kinematics, travelTimes);
+        ownedCars.back()->setEventBus(&eventBus);
     }
-    
-    // Connect to the database
-#ifndef ELEVATOR_TESTING
-    dbLogger->connect();
-#endif
+    publishCarSet();
 }
 
 ElevatorController::~ElevatorController() {
@@ -34,8 +49,13 @@ void ElevatorController::start() {
     
     running = true;
     
+    // Connect in the background; the database sink buffers events until it is up
+    eventSink->open();
+    sinkRunning = true;
+    sinkThread = std::thread(&ElevatorController::sinkLoop, this);
+    
     // Start all elevators
-    for (auto& elevator : elevators) {
+    for (Elevator* elevator : carSet().elevators) {
         elevator->start();
     }
     
@@ -43,10 +63,14 @@ void ElevatorController::start() {
     dispatcherThread = std::thread(&ElevatorController::dispatcherLoop, this);
     
     // Log system start
-    dbLogger->logSystemEvent(LogEventType::SYSTEM_STARTED);
+    logEvent(LogEventType::SYSTEM_STARTED);
     
     // Start sync thread
     startSyncThread();
+    
+    if (!checkpointPath.empty() && checkpointInterval.count() > 0) {
+        checkpointThread = std::thread(&ElevatorController::checkpointLoop, this);
+    }
 }
 
 void ElevatorController::stop() {
@@ -57,19 +81,38 @@ void ElevatorController::stop() {
     running = false;
     syncRunning = false;
     
-    // Log system stop
-    dbLogger->logSystemEvent(LogEventType::SYSTEM_STOPPED);
+    // Final checkpoint while the cars still hold their in-flight trips
+    {
+        std::lock_guard<ProfiledMutex> lock(checkpointMutex);
+        checkpointCV.notify_all();
+    }
+    if (checkpointThread.joinable()) {
+        checkpointThread.join();
+    }
+    if (!checkpointPath.empty()) {
+        writeCheckpoint();
+    }
+    
+    // Wait for sync thread to finish, so no car is adopted after this
+    if (syncSubscription) {
+        syncSubscription->wake();
+    }
+    if (syncThread.joinable()) {
+        syncThread.join();
+    }
+    if (syncSubscription) {
+        eventBus.unsubscribe(syncSubscription);
+        syncSubscription.reset();
+    }
     
     // Stop all elevators
-    for (auto& elevator : elevators) {
-        if (elevator) {  // Check pointer is valid
-            elevator->stop();
-        }
+    for (Elevator* elevator : carSet().elevators) {
+        elevator->stop();
     }
     
     // Notify dispatcher thread to exit
     {
-        std::unique_lock<std::mutex> lock(requestMutex);
+        std::unique_lock<ProfiledMutex> lock(requestMutex);
         requestCV.notify_all();
     }
     
@@ -78,84 +121,202 @@ void ElevatorController::stop() {
         dispatcherThread.join();
     }
     
-    // Wait for sync thread to finish
-    if (syncThread.joinable()) {
-        syncThread.join();
-    }
+    // Log system stop once the cars are quiet, so it is the last event
+    logEvent(LogEventType::SYSTEM_STOPPED);
     
-    // Disconnect from database
-#ifndef ELEVATOR_TESTING
-    if (dbLogger) {
-        dbLogger->disconnect();
+    // Hand the sink everything published up to now, then disconnect
+    sinkRunning = false;
+    sinkSubscription->wake();
+    if (sinkThread.joinable()) {
+        sinkThread.join();
     }
-#endif
+    eventSink->close();
 }
 
 void ElevatorController::emergencyStop() {
-    for (auto& elevator : elevators) {
+    for (Elevator* elevator : carSet().elevators) {
         elevator->emergencyStopActivate();
     }
     
     // Log emergency stop
-    if (dbLogger->isConnected()) {
-        dbLogger->logSystemEvent(LogEventType::EMERGENCY_STOP);
-    }
+    logEvent(LogEventType::EMERGENCY_STOP);
 }
 
 void ElevatorController::releaseEmergencyStop() {
-    for (auto& elevator : elevators) {
+    for (Elevator* elevator : carSet().elevators) {
         elevator->emergencyStopRelease();
     }
     
     // Log emergency release
-    if (dbLogger->isConnected()) {
-        dbLogger->logSystemEvent(LogEventType::EMERGENCY_RELEASED);
-    }
+    logEvent(LogEventType::EMERGENCY_RELEASED);
 }
 
-void ElevatorController::addRequest(int fromFloor, int toFloor, Direction direction) {
+bool ElevatorController::validateRequest(int fromFloor, int toFloor, int passengers) const {
     // Validate the fromFloor
     if (fromFloor < 1 || fromFloor > numFloors) {
         std::cerr << "Invalid source floor number. Floors must be between 1 and " << numFloors << std::endl;
-        return;
+        return false;
     }
     
     // Validate the toFloor - 0 is a special case used for "call" commands
     if (toFloor != 0 && (toFloor < 1 || toFloor > numFloors)) {
         std::cerr << "Invalid destination floor number. Floors must be between 1 and " << numFloors << std::endl;
-        return;
+        return false;
+    }
+    
+    if (passengers < 1) {
+        std::cerr << "Invalid passenger count. At least one passenger must travel" << std::endl;
+        return false;
     }
     
-    Request request(fromFloor, toFloor, direction);
+    // Requests no car can serve would otherwise be requeued forever
+    if (!isServable(fromFloor, toFloor)) {
+        std::cerr << "No elevator serves both floor " << fromFloor << " and floor " << toFloor << std::endl;
+        return false;
+    }
+    
+    return true;
+}
+
+bool ElevatorController::addRequest(int fromFloor, int toFloor, Direction direction, int passengers) {
+    TRACE_SCOPE("ElevatorController::addRequest");
+    
+    if (!validateRequest(fromFloor, toFloor, passengers)) {
+        return false;
+    }
+    
+    Request request(fromFloor, toFloor, direction, passengers);
+    arrivalStats.record(fromFloor, request.timestamp);
     
     {
-        std::lock_guard<std::mutex> lock(requestMutex);
+        std::unique_lock<ProfiledMutex> lock(requestMutex);
         pendingRequests.push(request);
     }
     
     // Log the request
-    if (dbLogger->isConnected()) {
-        dbLogger->logEvent(LogEventType::CALL_REQUEST, 0, fromFloor, toFloor);
+    logEvent(LogEventType::CALL_REQUEST, 0, fromFloor, toFloor);
+    
+    requestCV.notify_one();
+    return true;
+}
+
+std::optional<int> ElevatorController::addDestinationCall(int fromFloor, int toFloor, int passengers) {
+    TRACE_SCOPE("ElevatorController::addDestinationCall");
+    
+    if (toFloor == 0 || toFloor == fromFloor) {
+        std::cerr << "A destination call needs a destination other than the origin floor" << std::endl;
+        return std::nullopt;
+    }
+    
+    if (!validateRequest(fromFloor, toFloor, passengers)) {
+        return std::nullopt;
+    }
+    
+    Request request(fromFloor, toFloor, toFloor > fromFloor ? Direction::UP : Direction::DOWN, passengers);
+    arrivalStats.record(fromFloor, request.timestamp);
+    logEvent(LogEventType::CALL_REQUEST, 0, fromFloor, toFloor);
+    
+    // Assign immediately so the keypad can tell the passengers which car to take
+    Elevator* car = nullptr;
+    {
+        // Queued before assignMutex is released, so a snapshot always finds it
+        std::lock_guard<ProfiledMutex> lock(assignMutex);
+        car = assignRequest(request);
+        if (!car) {
+            // Every eligible car is full or stopped; the dispatcher retries
+            std::lock_guard<ProfiledMutex> requestLock(requestMutex);
+            pendingRequests.push(request);
+        }
+    }
+    
+    if (car) {
+        logEvent(LogEventType::ELEVATOR_DISPATCHED, car->getId(), fromFloor, toFloor);
+        return car->getId();
     }
     
     requestCV.notify_one();
+    return -1;
+}
+
+void ElevatorController::logEvent(LogEventType eventType, int elevatorId, int fromFloor, int toFloor) {
+    eventBus.publish(eventType, elevatorId, fromFloor, toFloor);
+}
+
+void ElevatorController::sinkLoop() {
+    TRACE_THREAD_NAME("event-sink");
+    
+    EventRecord event;
+    while (sinkRunning) {
+        sinkSubscription->waitFor(std::chrono::seconds(1));
+        while (sinkSubscription->poll(event)) {
+            eventSink->logEvent(event.type, event.elevatorId, event.fromFloor, event.toFloor);
+        }
+    }
+    
+    // Drain what was published while stopping
+    while (sinkSubscription->poll(event)) {
+        eventSink->logEvent(event.type, event.elevatorId, event.fromFloor, event.toFloor);
+    }
+}
+
+// Restrict the calling thread to one CPU so a shard's dispatcher keeps its
+// queue and car state warm in that core's cache
+static void pinCurrentThread(int cpu) {
+#ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if (err != 0) {
+        std::cerr << "Could not pin dispatcher to CPU " << cpu << ": " << strerror(err) << std::endl;
+    }
+#else
+    (void)cpu;
+#endif
 }
 
 void ElevatorController::dispatcherLoop() {
+    TRACE_THREAD_NAME("dispatcher");
+    
+    if (dispatcherCpu >= 0) {
+        pinCurrentThread(dispatcherCpu);
+    }
+    
+    // Requests requeued in a row without any being dispatched
+    size_t consecutiveRequeues = 0;
+    auto nextRebalance = std::chrono::steady_clock::now() + REBALANCE_INTERVAL;
+    
     while (running) {
         Request currentRequest{0, 0, Direction::IDLE};
         bool hasRequest = false;
         
         {
-            std::unique_lock<std::mutex> lock(requestMutex);
-            requestCV.wait(lock, [this] {
+            std::unique_lock<ProfiledMutex> lock(requestMutex);
+            requestCV.wait_until(lock, nextRebalance, [this] {
                 return !running || !pendingRequests.empty();
             });
             
             if (!running) {
                 break;
             }
-            
+        }
+        
+        if (std::chrono::steady_clock::now() >= nextRebalance) {
+            if (reassignCalls) {
+                reassignQueuedCalls();
+            }
+            if (parkIdle) {
+                parkIdleCars();
+            }
+            nextRebalance = std::chrono::steady_clock::now() + REBALANCE_INTERVAL;
+        }
+        
+        // Popped, assigned or requeued under assignMutex, so a snapshot never
+        // misses a request that is in neither the queue nor a car
+        std::unique_lock<ProfiledMutex> assignLock(assignMutex);
+        {
+            std::lock_guard<ProfiledMutex> lock(requestMutex);
             if (!pendingRequests.empty()) {
                 currentRequest = pendingRequests.front();
                 pendingRequests.pop();
@@ -164,59 +325,299 @@ void ElevatorController::dispatcherLoop() {
         }
         
         if (hasRequest) {
-            Elevator* bestElevator = findBestElevator(currentRequest);
+            TRACE_SCOPE("ElevatorController::dispatch");
+            queueWaitLatency.record(std::chrono::system_clock::now() - currentRequest.timestamp);
+            ScopedLatency dispatchTimer(dispatchLatency);
+            
+            Elevator* bestElevator = assignRequest(currentRequest);
             
             if (bestElevator) {
-                bestElevator->addRequest(currentRequest);
+                assignLock.unlock();
+                consecutiveRequeues = 0;
                 
                 // Log elevator dispatch
-                if (dbLogger->isConnected()) {
-                    dbLogger->logEvent(LogEventType::ELEVATOR_DISPATCHED, 
-                                      bestElevator->getId(), 
-                                      currentRequest.fromFloor, 
-                                      currentRequest.toFloor);
-                }
+                logEvent(LogEventType::ELEVATOR_DISPATCHED, 
+                         bestElevator->getId(), 
+                         currentRequest.fromFloor, 
+                         currentRequest.toFloor);
             } else {
                 // If no elevator is available, put the request back in the queue
-                std::lock_guard<std::mutex> lock(requestMutex);
+                std::unique_lock<ProfiledMutex> lock(requestMutex);
                 pendingRequests.push(currentRequest);
+                assignLock.unlock();
+                
+                // Once every queued request has failed, wait for cars to free
+                // up instead of spinning over the queue
+                if (++consecutiveRequeues >= pendingRequests.size()) {
+                    consecutiveRequeues = 0;
+                    requestCV.wait_for(lock, DISPATCH_RETRY_INTERVAL, [this] { return !running; });
+                }
+            }
+        }
+    }
+}
+
+void ElevatorController::reassignQueuedCalls() {
+    TRACE_SCOPE("ElevatorController::reassignQueuedCalls");
+    
+    // Keypad passengers were told which car to board, so their trips stay put
+    bool keypadAssigned = dispatchMode == DispatchMode::DESTINATION;
+    
+    std::lock_guard<ProfiledMutex> lock(assignMutex);
+    for (Elevator* owner : carSet().elevators) {
+        owner->getQueuedCalls(reassignScratch);
+        bool stopped = owner->hasEmergencyStop();
+        
+        // At most one call leaves a car per pass, so the ETAs compared are
+        // never stale from an earlier move
+        for (const auto& call : reassignScratch) {
+            if (keypadAssigned && call.request.toFloor != 0) {
+                continue;
+            }
+            
+            Elevator* better = findBestElevator(call.request, owner);
+            if (!better) {
+                continue;
+            }
+            auto currentEta = stopped ? std::chrono::milliseconds::max() : call.pickupEta;
+            if (currentEta - better->estimateTravelTime(call.request.fromFloor) < REASSIGN_MIN_GAIN) {
+                continue;
+            }
+            
+            // The owner may have started the trip since we looked
+            auto withdrawn = owner->withdrawQueuedCall(call.request);
+            if (!withdrawn) {
+                continue;
+            }
+            
+            if (better->addRequest(*withdrawn)) {
+                reassignedRequests.fetch_add(1, std::memory_order_relaxed);
+                logEvent(LogEventType::CALL_REASSIGNED, better->getId(), withdrawn->fromFloor, withdrawn->toFloor);
+            } else {
+                // The new car stopped in the meantime; dispatch afresh
+                std::lock_guard<ProfiledMutex> requestLock(requestMutex);
+                pendingRequests.push(*withdrawn);
+            }
+            break;
+        }
+    }
+}
+
+void ElevatorController::parkIdleCars() {
+    TRACE_SCOPE("ElevatorController::parkIdleCars");
+    
+    arrivalStats.getRates(std::chrono::system_clock::now(), parkingDemand);
+    double totalDemand = 0.0;
+    for (double rate : parkingDemand) {
+        totalDemand += rate;
+    }
+    if (totalDemand < PARK_MIN_DEMAND) {
+        return;
+    }
+    
+    parkingCars.clear();
+    for (Elevator* car : carSet().elevators) {
+        if (!car->hasEmergencyStop() && car->isIdle() && car->getQueueDepth() == 0) {
+            parkingCars.push_back(car);
+        }
+    }
+    if (parkingCars.empty()) {
+        return;
+    }
+    
+    auto servedByIdleCar = [this](int floor) {
+        return std::any_of(parkingCars.begin(), parkingCars.end(), [floor](Elevator* car) {
+            return car->servesFloor(floor);
+        });
+    };
+    auto waitingAt = [this](int floor) {
+        return std::any_of(parkingCars.begin(), parkingCars.end(), [floor](Elevator* car) {
+            return car->getCurrentFloor() == floor;
+        });
+    };
+    
+    // Greedy placement: each pick is the floor that most cuts the
+    // demand-weighted travel time from the nearest floor picked so far
+    double longestRun = static_cast<double>(travelTimes->travelTime(1, numFloors).count());
+    parkingCover.assign(numFloors + 1, longestRun);
+    parkingFloors.clear();
+    while (parkingFloors.size() < parkingCars.size()) {
+        int bestFloor = 0;
+        double bestGain = 0.0;
+        for (int candidate = 1; candidate <= numFloors; candidate++) {
+            if (!servedByIdleCar(candidate)) {
+                continue;
+            }
+            
+            double gain = 0.0;
+            for (int floor = 1; floor <= numFloors; floor++) {
+                double run = static_cast<double>(travelTimes->travelTime(candidate, floor).count());
+                gain += parkingDemand[floor] * std::max(0.0, parkingCover[floor] - run);
+            }
+            if (waitingAt(candidate)) {
+                gain *= 1.0 + PARK_STAY_BONUS;
+            }
+            
+            if (gain > bestGain) {
+                bestGain = gain;
+                bestFloor = candidate;
             }
         }
+        
+        // Every expected call is already as close as it can get
+        if (bestFloor == 0) {
+            break;
+        }
+        
+        parkingFloors.push_back(bestFloor);
+        for (int floor = 1; floor <= numFloors; floor++) {
+            double run = static_cast<double>(travelTimes->travelTime(bestFloor, floor).count());
+            parkingCover[floor] = std::min(parkingCover[floor], run);
+        }
+    }
+    
+    // Pair cars with the picked floors, shortest runs first; a car already
+    // at a picked floor stays there
+    while (!parkingFloors.empty() && !parkingCars.empty()) {
+        size_t bestCar = parkingCars.size();
+        size_t bestFloor = 0;
+        auto bestRun = std::chrono::milliseconds::max();
+        for (size_t c = 0; c < parkingCars.size(); c++) {
+            for (size_t f = 0; f < parkingFloors.size(); f++) {
+                if (!parkingCars[c]->servesFloor(parkingFloors[f])) {
+                    continue;
+                }
+                auto run = travelTimes->travelTime(parkingCars[c]->getCurrentFloor(), parkingFloors[f]);
+                if (run < bestRun) {
+                    bestRun = run;
+                    bestCar = c;
+                    bestFloor = f;
+                }
+            }
+        }
+        if (bestCar == parkingCars.size()) {
+            break;
+        }
+        
+        Elevator* car = parkingCars[bestCar];
+        int from = car->getCurrentFloor();
+        int target = parkingFloors[bestFloor];
+        if (target != from && car->park(target)) {
+            parkingMoves.fetch_add(1, std::memory_order_relaxed);
+            logEvent(LogEventType::ELEVATOR_PARKING, car->getId(), from, target);
+        }
+        
+        parkingCars.erase(parkingCars.begin() + bestCar);
+        parkingFloors.erase(parkingFloors.begin() + bestFloor);
     }
 }
 
-Elevator* ElevatorController::findBestElevator(const Request& request) {
+Elevator* ElevatorController::findBestElevator(const Request& request, const Elevator* exclude) {
+    TRACE_SCOPE("ElevatorController::findBestElevator");
+    
     Elevator* bestElevator = nullptr;
-    int shortestDistance = std::numeric_limits<int>::max();
+    auto shortestTime = std::chrono::milliseconds::max();
     
-    for (auto& elevator : elevators) {
+    // Call requests (toFloor 0) only need a car that stops at the pickup floor
+    const CarSet& cars = carSet();
+    const Bitmask& pickupCars = cars.floorCars[request.fromFloor];
+    const Bitmask& destinationCars = request.toFloor != 0 ? cars.floorCars[request.toFloor] : pickupCars;
+    
+    forEachCommonBit(pickupCars, destinationCars, [&](size_t index) {
+        Elevator* elevator = cars.elevators[index];
+        
         // Skip elevators in emergency stop
-        if (elevator->hasEmergencyStop()) {
-            continue;
+        if (elevator == exclude || elevator->hasEmergencyStop()) {
+            return;
         }
         
-        int distance = elevator->calculateDistance(request.fromFloor);
-        
-        // Prioritize idle elevators
-        if (elevator->isIdle()) {
-            distance -= numFloors; // Give idle elevators a significant advantage
+        // Full-car bypass: skip cars that are full or already committed to
+        // more waiting passengers than they have room for. A hall call still
+        // needs room for one person; a group larger than a car boards in
+        // parts, so it only needs an empty car.
+        int needed = std::min(std::max(request.passengers, 1), elevator->getCapacity());
+        if (elevator->getAvailableCapacity() < needed) {
+            return;
         }
         
+        // Each car keeps its committed work up to date as its queue changes,
+        // so scoring is O(1) per car however long the queues are
+        auto time = elevator->estimateTravelTime(request.fromFloor);
+        
         // If this elevator is better than our current best, update
-        if (distance < shortestDistance) {
-            shortestDistance = distance;
-            bestElevator = elevator.get();
+        if (time < shortestTime) {
+            shortestTime = time;
+            bestElevator = elevator;
         }
-    }
+    });
     
     return bestElevator;
 }
 
+Elevator* ElevatorController::assignRequest(const Request& request) {
+    // Destination dispatch: ride with passengers already waiting for the same trip
+    if (dispatchMode == DispatchMode::DESTINATION && request.toFloor != 0) {
+        const CarSet& cars = carSet();
+        Elevator* joined = nullptr;
+        forEachCommonBit(cars.floorCars[request.fromFloor], cars.floorCars[request.toFloor], [&](size_t index) {
+            if (!joined && cars.elevators[index]->joinQueuedRequest(request)) {
+                joined = cars.elevators[index];
+            }
+        });
+        
+        if (joined) {
+            groupedRequests.fetch_add(1, std::memory_order_relaxed);
+            return joined;
+        }
+    }
+    
+    Elevator* bestElevator = findBestElevator(request);
+    if (bestElevator && bestElevator->addRequest(request)) {
+        return bestElevator;
+    }
+    
+    return nullptr;
+}
+
+bool ElevatorController::isServable(int fromFloor, int toFloor) const {
+    const CarSet& cars = carSet();
+    const Bitmask& pickupCars = cars.floorCars[fromFloor];
+    const Bitmask& destinationCars = toFloor != 0 ? cars.floorCars[toFloor] : pickupCars;
+    
+    bool servable = false;
+    forEachCommonBit(pickupCars, destinationCars, [&servable](size_t) { servable = true; });
+    return servable;
+}
+
+void ElevatorController::publishCarSet() {
+    auto cars = std::make_unique<CarSet>();
+    cars->floorCars.assign(numFloors + 1, Bitmask(ownedCars.size()));
+    
+    for (size_t index = 0; index < ownedCars.size(); index++) {
+        cars->elevators.push_back(ownedCars[index].get());
+        for (int floor = 1; floor <= numFloors; floor++) {
+            if (ownedCars[index]->servesFloor(floor)) {
+                cars->floorCars[floor].set(index);
+            }
+        }
+    }
+    
+    // Readers may still hold the previous set; it stays in carSets
+    currentCars.store(cars.get(), std::memory_order_release);
+    carSets.push_back(std::move(cars));
+}
+
 std::vector<std::tuple<int, int, int, Direction, ElevatorStatus>> ElevatorController::getElevatorStatuses() const {
     std::vector<std::tuple<int, int, int, Direction, ElevatorStatus>> statuses;
+    getElevatorStatuses(statuses);
+    return statuses;
+}
+
+void ElevatorController::getElevatorStatuses(std::vector<ElevatorStatusRow>& out) const {
+    out.clear();
     
-    for (const auto& elevator : elevators) {
-        statuses.emplace_back(
+    for (Elevator* elevator : carSet().elevators) {
+        out.emplace_back(
             elevator->getId(),
             elevator->getCurrentFloor(),
             elevator->getDestinationFloor(),
@@ -224,52 +625,403 @@ std::vector<std::tuple<int, int, int, Direction, ElevatorStatus>> ElevatorContro
             elevator->getStatus()
         );
     }
+}
+
+std::vector<EventRecord> ElevatorController::getRecentEvents(size_t limit) const {
+    std::vector<EventRecord> events;
+    events.reserve(std::min(limit, eventBus.getHistoryCapacity()));
+    eventBus.getRecent(events, limit);
+    return events;
+}
+
+size_t ElevatorController::getRecentEventCapacity() const {
+    return eventBus.getHistoryCapacity();
+}
+
+EventBus& ElevatorController::getEventBus() {
+    return eventBus;
+}
+
+std::vector<EventSink::LogRow> ElevatorController::getLoggedEvents(int limit, std::chrono::system_clock::time_point before) {
+    if (!eventSink->isConnected()) {
+        return {};
+    }
     
-    return statuses;
+    return eventSink->getRecentLogs(limit, before);
+}
+
+void ElevatorController::getElevatorMetrics(std::vector<ElevatorMetrics>& out) const {
+    out.clear();
+    
+    for (Elevator* elevator : carSet().elevators) {
+        out.push_back(ElevatorMetrics{
+            elevator->getId(),
+            elevator->getTripsCompleted(),
+            elevator->getFloorsTravelled(),
+            elevator->getDoorCycles(),
+            elevator->getQueueDepth(),
+            elevator->getLoad(),
+            elevator->getCapacity(),
+            elevator->getPassengersDelivered()
+        });
+    }
+}
+
+size_t ElevatorController::getPendingRequestCount() const {
+    std::lock_guard<ProfiledMutex> lock(requestMutex);
+    return pendingRequests.size();
+}
+
+LatencyHistogram::Snapshot ElevatorController::getQueueWaitLatency() const {
+    return queueWaitLatency.snapshot();
+}
+
+LatencyHistogram::Snapshot ElevatorController::getDispatchLatency() const {
+    return dispatchLatency.snapshot();
+}
+
+LatencyHistogram::Snapshot ElevatorController::getDatabaseWriteLatency() const {
+    return eventSink->getWriteLatency();
+}
+
+EventSink::EventCounters ElevatorController::getDatabaseEventCounters() const {
+    auto counters = eventSink->getEventCounters();
+    // Events the sink never received because its bus queue was full
+    counters.dropped += sinkSubscription->getDropped();
+    return counters;
+}
+
+size_t ElevatorController::getBufferedDatabaseEvents() const {
+    return eventSink->getBufferedEventCount();
+}
+
+int ElevatorController::getHandlingCapacity() const {
+    int total = 0;
+    for (Elevator* elevator : carSet().elevators) {
+        total += elevator->getRecentDeliveries();
+    }
+    return total;
+}
+
+uint64_t ElevatorController::getPassengersDelivered() const {
+    uint64_t total = 0;
+    for (Elevator* elevator : carSet().elevators) {
+        total += elevator->getPassengersDelivered();
+    }
+    return total;
 }
 
 int ElevatorController::getNumElevators() const {
-    return elevators.size();
+    return carSet().elevators.size();
 }
 
 int ElevatorController::getNumFloors() const {
     return numFloors;
 }
 
+void ElevatorController::setDispatcherCpu(int cpu) {
+    dispatcherCpu = cpu;
+}
+
+void ElevatorController::setAdoptDatabaseElevators(bool adopt) {
+    adoptDatabaseElevators = adopt;
+}
+
+bool ElevatorController::setServedFloors(int elevatorId, const Bitmask& floors) {
+    if (running) {
+        return false;
+    }
+    
+    for (Elevator* elevator : carSet().elevators) {
+        if (elevator->getId() == elevatorId) {
+            if (!elevator->setServedFloors(floors)) {
+                return false;
+            }
+            publishCarSet();
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+bool ElevatorController::setCapacity(int elevatorId, int passengers) {
+    if (running || passengers < 1) {
+        return false;
+    }
+    
+    bool found = false;
+    for (Elevator* elevator : carSet().elevators) {
+        if (elevatorId < 0 || elevator->getId() == elevatorId) {
+            found = elevator->setCapacity(passengers) || found;
+        }
+    }
+    return found;
+}
+
+bool ElevatorController::setKinematics(const KinematicConfig& config) {
+    if (running || config.timeScale <= 0.0 || config.motion.maxSpeed <= 0.0 ||
+        config.motion.acceleration <= 0.0 || config.motion.jerk <= 0.0) {
+        return false;
+    }
+    
+    auto table = config.buildTable(numFloors);
+    for (Elevator* elevator : carSet().elevators) {
+        if (!elevator->setKinematics(config, table)) {
+            return false;
+        }
+    }
+    
+    kinematics = config;
+    travelTimes = std::move(table);
+    return true;
+}
+
+const KinematicConfig& ElevatorController::getKinematics() const {
+    return kinematics;
+}
+
+const TravelTimeTable& ElevatorController::getTravelTimes() const {
+    return *travelTimes;
+}
+
+void ElevatorController::setDispatchMode(DispatchMode mode) {
+    dispatchMode = mode;
+    
+    // Destination dispatch holds the doors for a door cycle at each pickup so
+    // passengers keying in the same trip can still join the car
+    auto hold = mode == DispatchMode::DESTINATION ? DESTINATION_BOARDING_HOLD : std::chrono::milliseconds(0);
+    for (Elevator* elevator : carSet().elevators) {
+        elevator->setBoardingHold(hold);
+    }
+}
+
+DispatchMode ElevatorController::getDispatchMode() const {
+    return dispatchMode;
+}
+
+uint64_t ElevatorController::getGroupedRequestCount() const {
+    return groupedRequests.load(std::memory_order_relaxed);
+}
+
+void ElevatorController::setCallReassignment(bool enabled) {
+    reassignCalls = enabled;
+}
+
+bool ElevatorController::isCallReassignmentEnabled() const {
+    return reassignCalls;
+}
+
+uint64_t ElevatorController::getReassignedRequestCount() const {
+    return reassignedRequests.load(std::memory_order_relaxed);
+}
+
+void ElevatorController::setParkingPolicy(bool enabled) {
+    parkIdle = enabled;
+}
+
+bool ElevatorController::isParkingPolicyEnabled() const {
+    return parkIdle;
+}
+
+uint64_t ElevatorController::getParkingMoveCount() const {
+    return parkingMoves.load(std::memory_order_relaxed);
+}
+
+bool ElevatorController::hasElevator(int elevatorId) const {
+    for (Elevator* elevator : carSet().elevators) {
+        if (elevator->getId() == elevatorId) {
+            return true;
+        }
+    }
+    return false;
+}
+
+ControllerSnapshot ElevatorController::snapshot() const {
+    // No request is between the pending queue and a car while this is held
+    std::lock_guard<ProfiledMutex> assignLock(assignMutex);
+    
+    ControllerSnapshot snapshot;
+    snapshot.floors = numFloors;
+    snapshot.dispatchMode = dispatchMode;
+    
+    for (Elevator* elevator : carSet().elevators) {
+        snapshot.cars.push_back(CarSnapshot{
+            elevator->getId(),
+            elevator->getCurrentFloor(),
+            elevator->hasEmergencyStop(),
+            elevator->getOutstandingRequests()
+        });
+    }
+    
+    std::lock_guard<ProfiledMutex> lock(requestMutex);
+    std::queue<Request> pending = pendingRequests;
+    while (!pending.empty()) {
+        snapshot.pending.push_back(pending.front());
+        pending.pop();
+    }
+    
+    return snapshot;
+}
+
+bool ElevatorController::restore(const ControllerSnapshot& snapshot) {
+    if (running) {
+        return false;
+    }
+    
+    if (snapshot.floors != numFloors) {
+        std::cerr << "Checkpoint is for a " << snapshot.floors << "-floor building, not "
+                  << numFloors << " floors; ignoring it" << std::endl;
+        return false;
+    }
+    
+    setDispatchMode(snapshot.dispatchMode);
+    
+    auto inRange = [this](const Request& request) {
+        return request.fromFloor >= 1 && request.fromFloor <= numFloors &&
+               request.toFloor >= 0 && request.toFloor <= numFloors;
+    };
+    
+    // Work a car can no longer do (it was removed or rezoned) is dispatched afresh
+    const CarSet& cars = carSet();
+    std::vector<Request> orphaned;
+    for (const auto& car : snapshot.cars) {
+        auto elevator = std::find_if(cars.elevators.begin(), cars.elevators.end(), [&](const Elevator* candidate) {
+            return candidate->getId() == car.id;
+        });
+        
+        std::vector<Request> kept;
+        for (const auto& request : car.requests) {
+            bool serves = elevator != cars.elevators.end() && inRange(request) &&
+                          (*elevator)->servesFloor(request.fromFloor) &&
+                          (request.toFloor == 0 || (*elevator)->servesFloor(request.toFloor));
+            (serves ? kept : orphaned).push_back(request);
+        }
+        
+        if (elevator != cars.elevators.end() && !(*elevator)->restore(car.floor, car.emergency, kept)) {
+            orphaned.insert(orphaned.end(), kept.begin(), kept.end());
+        }
+    }
+    
+    orphaned.insert(orphaned.end(), snapshot.pending.begin(), snapshot.pending.end());
+    
+    size_t dropped = 0;
+    std::lock_guard<ProfiledMutex> lock(requestMutex);
+    for (const auto& request : orphaned) {
+        if (inRange(request) && isServable(request.fromFloor, request.toFloor)) {
+            pendingRequests.push(request);
+        } else {
+            dropped++;
+        }
+    }
+    
+    if (dropped > 0) {
+        std::cerr << "Dropped " << dropped << " checkpointed requests that no car can serve" << std::endl;
+    }
+    
+    return true;
+}
+
+void ElevatorController::setCheckpointFile(const std::string& path, std::chrono::milliseconds interval) {
+    if (running) {
+        return;
+    }
+    checkpointPath = path;
+    checkpointInterval = interval;
+}
+
+bool ElevatorController::writeCheckpoint() const {
+    TRACE_SCOPE("ElevatorController::writeCheckpoint");
+    return !checkpointPath.empty() && writeSnapshotFile(checkpointPath, snapshot());
+}
+
+void ElevatorController::checkpointLoop() {
+    TRACE_THREAD_NAME("checkpoint");
+    
+    std::unique_lock<ProfiledMutex> lock(checkpointMutex);
+    while (running) {
+        if (checkpointCV.wait_for(lock, checkpointInterval, [this] { return !running; })) {
+            break;
+        }
+        
+        lock.unlock();
+        writeCheckpoint();
+        lock.lock();
+    }
+}
+
 void ElevatorController::startSyncThread() {
-#ifndef ELEVATOR_TESTING
+    uint32_t stateChanges = EventBus::typeBit(LogEventType::ELEVATOR_DEPARTED) |
+                            EventBus::typeBit(LogEventType::FLOOR_PASSED) |
+                            EventBus::typeBit(LogEventType::ELEVATOR_ARRIVED) |
+                            EventBus::typeBit(LogEventType::DOOR_OPENED) |
+                            EventBus::typeBit(LogEventType::DOOR_CLOSED) |
+                            EventBus::typeBit(LogEventType::EMERGENCY_STOP) |
+                            EventBus::typeBit(LogEventType::EMERGENCY_RELEASED);
+    syncSubscription = eventBus.subscribe(stateChanges);
     syncRunning = true;
     syncThread = std::thread(&ElevatorController::syncWithDatabase, this);
-#endif
 }
 
 void ElevatorController::syncWithDatabase() {
-#ifndef ELEVATOR_TESTING
-    if (!dbLogger->isConnected()) {
-        return;
-    }
+    TRACE_THREAD_NAME("db-sync");
+    
+    // Every car is written after (re)connecting, then only cars with news
+    bool fullSync = true;
+    std::vector<int> changed;
+    auto nextAdoption = std::chrono::steady_clock::now();
+    EventRecord event;
     
     while (syncRunning) {
-        // First, sync our elevator states to the database
-        for (const auto& elevator : elevators) {
+        syncSubscription->waitFor(SYNC_ADOPT_INTERVAL);
+        
+        changed.clear();
+        while (syncSubscription->poll(event)) {
+            // Building-wide events (emergency stop and release) touch every car
+            if (event.elevatorId < 0) {
+                fullSync = true;
+            } else {
+                changed.push_back(event.elevatorId);
+            }
+        }
+        
+        // The connection is made in the background; catch up once it is there
+        if (!eventSink->isConnected()) {
+            fullSync = true;
+            continue;
+        }
+        
+        for (Elevator* elevator : carSet().elevators) {
             int id = elevator->getId();
+            if (!fullSync && std::find(changed.begin(), changed.end(), id) == changed.end()) {
+                continue;
+            }
+            
             int currentFloor = elevator->getCurrentFloor();
             int destFloor = elevator->getDestinationFloor();
             int direction = static_cast<int>(elevator->getDirection());
             int status = static_cast<int>(elevator->getStatus());
             
-            dbLogger->syncElevatorState(id, currentFloor, destFloor, direction, status);
+            eventSink->syncElevatorState(id, currentFloor, destFloor, direction, status);
+        }
+        fullSync = false;
+        
+        // Rows of other instances change rarely; look for them once per interval
+        auto now = std::chrono::steady_clock::now();
+        if (!adoptDatabaseElevators || now < nextAdoption) {
+            continue;
         }
+        nextAdoption = now + SYNC_ADOPT_INTERVAL;
         
-        // Then, check if there are any states in the database we need to sync with
-        auto dbStates = dbLogger->getElevatorStates();
+        auto dbStates = eventSink->getElevatorStates();
         
         // If we have fewer elevators than in the database, we need to add more
-        if (dbStates.size() > elevators.size()) {
+        if (dbStates.size() > ownedCars.size()) {
+            bool adopted = false;
             for (const auto& [id, currentFloor, destFloor, direction, status] : dbStates) {
                 // Check if this elevator exists in our system
                 bool found = false;
-                for (const auto& elevator : elevators) {
+                for (const auto& elevator : ownedCars) {
                     if (elevator->getId() == id) {
                         found = true;
                         break;
@@ -279,14 +1031,18 @@ void ElevatorController::syncWithDatabase() {
                 // If not found, create a new elevator with the state from the database
                 if (!found) {
                     auto newElevator = std::make_unique<Elevator>(id, currentFloor, numFloors);
+                    newElevator->setKinematics(kinematics, travelTimes);
+                    newElevator->setEventBus(&eventBus);
                     newElevator->start();
-                    elevators.push_back(std::move(newElevator));
+                    ownedCars.push_back(std::move(newElevator));
+                    adopted = true;
                 }
             }
+            
+            // Dispatch sees the new cars only once they are running
+            if (adopted) {
+                publishCarSet();
+            }
         }
-        
-        // Sleep for a while before next sync - exactly 1 second to match floor travel time
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
     }
-#endif
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "ElevatorServer.h"
+#include "EnumStrings.h"
+#include "Trace.h"
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -8,36 +10,38 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <sys/select.h>
+#include <poll.h>
 #include <fcntl.h>
 #include <limits>
 #include <algorithm>
+#include <charconv>
+#include <sys/uio.h>
 
-ElevatorServer::ElevatorServer(ElevatorController& controller, int port)
-    : controller(controller), running(false), port(port), serverSocket(-1) {
+ElevatorServer::ElevatorServer(ShardedController& shards, int port)
+    : shards(shards), running(false), port(port), serverSocket(-1),
+      nextConnectionId(0), maxConnections(64), idleTimeout(std::chrono::minutes(5)),
+      activeConnections(0), acceptedConnections(0), rejectedConnections(0),
+      timedOutConnections(0), metricsPort(0), httpSocket(-1) {
 }
 
 ElevatorServer::~ElevatorServer() {
     stop();
 }
 
-bool ElevatorServer::start() {
-    if (running) {
-        return true; // Already running
-    }
-    
+int ElevatorServer::openListeningSocket(int listenPort) {
     // Create socket
-    serverSocket = socket(AF_INET, SOCK_STREAM, 0);
-    if (serverSocket < 0) {
+    int listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenSocket < 0) {
         std::cerr << "Error opening socket: " << strerror(errno) << std::endl;
-        return false;
+        return -1;
     }
     
     // Set socket options to reuse address
     int opt = 1;
-    if (setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+    if (setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
         std::cerr << "Error setting socket options: " << strerror(errno) << std::endl;
-        close(serverSocket);
-        return false;
+        close(listenSocket);
+        return -1;
     }
     
     // Bind to the port
@@ -45,26 +49,52 @@ bool ElevatorServer::start() {
     memset(&serverAddr, 0, sizeof(serverAddr));
     serverAddr.sin_family = AF_INET;
     serverAddr.sin_addr.s_addr = INADDR_ANY;
-    serverAddr.sin_port = htons(port);
+    serverAddr.sin_port = htons(listenPort);
     
-    if (bind(serverSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
-        std::cerr << "Error binding socket: " << strerror(errno) << std::endl;
-        close(serverSocket);
-        return false;
+    if (bind(listenSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
+        std::cerr << "Error binding socket to port " << listenPort << ": " << strerror(errno) << std::endl;
+        close(listenSocket);
+        return -1;
     }
     
     // Set socket to listen with a backlog of 5 connections
-    if (listen(serverSocket, 5) < 0) {
+    if (listen(listenSocket, 5) < 0) {
         std::cerr << "Error listening on socket: " << strerror(errno) << std::endl;
-        close(serverSocket);
+        close(listenSocket);
+        return -1;
+    }
+    
+    return listenSocket;
+}
+
+bool ElevatorServer::start() {
+    if (running) {
+        return true; // Already running
+    }
+    
+    serverSocket = openListeningSocket(port);
+    if (serverSocket < 0) {
         return false;
     }
     
+    if (metricsPort > 0) {
+        httpSocket = openListeningSocket(metricsPort);
+        if (httpSocket < 0) {
+            close(serverSocket);
+            serverSocket = -1;
+            return false;
+        }
+    }
+    
     // Start the server loop in a separate thread
     running = true;
     serverThread = std::thread(&ElevatorServer::serverLoop, this);
     
     std::cout << "Elevator server started on port " << port << std::endl;
+    if (httpSocket >= 0) {
+        std::cout << "Metrics endpoint listening on port " << metricsPort
+                  << " (/metrics, /status)" << std::endl;
+    }
     return true;
 }
 
@@ -75,48 +105,89 @@ void ElevatorServer::stop() {
     
     running = false;
     
-    // Close the server socket to interrupt accept()
+    // Wait for the server thread to notice (select() wakes at least once per second)
+    if (serverThread.joinable()) {
+        serverThread.join();
+    }
+    
     if (serverSocket >= 0) {
         close(serverSocket);
         serverSocket = -1;
     }
     
-    // Wait for the server thread to finish
-    if (serverThread.joinable()) {
-        serverThread.join();
+    if (httpSocket >= 0) {
+        close(httpSocket);
+        httpSocket = -1;
     }
     
-    // Close all client connections and join threads
-    std::lock_guard<std::mutex> lock(clientsMutex);
-    for (auto& client : activeClients) {
-        close(client.first);
+    // Wake client threads blocked in select() and join them. A session's
+    // socket is only closed by its own thread while holding clientsMutex,
+    // so the fds shut down here are still ours.
+    std::unordered_map<uint64_t, std::unique_ptr<ClientSession>> sessions;
+    {
+        std::lock_guard<ProfiledMutex> lock(clientsMutex);
+        for (auto& [id, session] : clients) {
+            if (!session->finished) {
+                shutdown(session->socket, SHUT_RDWR);
+            }
+        }
+        sessions.swap(clients);
     }
     
-    for (auto& thread : clientThreads) {
-        if (thread.joinable()) {
-            thread.join();
+    for (auto& [id, session] : sessions) {
+        if (session->thread.joinable()) {
+            session->thread.join();
         }
     }
     
-    activeClients.clear();
-    clientThreads.clear();
-    
     std::cout << "Elevator server stopped" << std::endl;
 }
 
+void ElevatorServer::setMaxConnections(size_t limit) {
+    maxConnections = limit;
+}
+
+void ElevatorServer::setIdleTimeout(std::chrono::seconds timeout) {
+    idleTimeout = timeout;
+}
+
+void ElevatorServer::setMetricsPort(int listenPort) {
+    metricsPort = listenPort;
+}
+
+ElevatorServer::ConnectionStats ElevatorServer::getConnectionStats() const {
+    return ConnectionStats{
+        activeConnections.load(),
+        acceptedConnections.load(),
+        rejectedConnections.load(),
+        timedOutConnections.load()
+    };
+}
+
 void ElevatorServer::serverLoop() {
+    TRACE_THREAD_NAME("server");
+    
     while (running) {
-        // Set up for select() to allow non-blocking accept
+        // Join threads of clients that have gone away since the last pass
+        reapFinishedClients();
+        
+        // Set up for select() to allow non-blocking accept on both the
+        // command port and the HTTP metrics port
         fd_set readFds;
         FD_ZERO(&readFds);
         FD_SET(serverSocket, &readFds);
+        int maxFd = serverSocket;
+        if (httpSocket >= 0) {
+            FD_SET(httpSocket, &readFds);
+            maxFd = std::max(maxFd, httpSocket);
+        }
         
         // Set timeout to 1 second to allow checking running flag periodically
         struct timeval timeout;
         timeout.tv_sec = 1;
         timeout.tv_usec = 0;
         
-        int ready = select(serverSocket + 1, &readFds, nullptr, nullptr, &timeout);
+        int ready = select(maxFd + 1, &readFds, nullptr, nullptr, &timeout);
         
         if (!running) {
             break;
@@ -134,60 +205,133 @@ void ElevatorServer::serverLoop() {
             continue;
         }
         
-        // Accept a new client connection
-        struct sockaddr_in clientAddr;
-        socklen_t clientLen = sizeof(clientAddr);
-        int clientSocket = accept(serverSocket, (struct sockaddr*)&clientAddr, &clientLen);
-        
-        if (clientSocket < 0) {
-            std::cerr << "Error accepting connection: " << strerror(errno) << std::endl;
-            continue;
+        if (FD_ISSET(serverSocket, &readFds)) {
+            acceptClient();
         }
         
-        // Get client info
-        char clientIP[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &clientAddr.sin_addr, clientIP, INET_ADDRSTRLEN);
-        std::cout << "New client connected from " << clientIP << ":" << ntohs(clientAddr.sin_port) << std::endl;
-        
-        // Add client to active clients
-        {
-            std::lock_guard<std::mutex> lock(clientsMutex);
-            activeClients[clientSocket] = true;
+        if (httpSocket >= 0 && FD_ISSET(httpSocket, &readFds)) {
+            handleHttpClient();
+        }
+    }
+}
+
+void ElevatorServer::acceptClient() {
+    struct sockaddr_in clientAddr;
+    socklen_t clientLen = sizeof(clientAddr);
+    int clientSocket = accept(serverSocket, (struct sockaddr*)&clientAddr, &clientLen);
+    
+    if (clientSocket < 0) {
+        std::cerr << "Error accepting connection: " << strerror(errno) << std::endl;
+        return;
+    }
+    
+    // Get client info
+    char clientIP[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &clientAddr.sin_addr, clientIP, INET_ADDRSTRLEN);
+    
+    if (activeConnections >= maxConnections) {
+        // Tell the client why before hanging up instead of leaving it in the backlog
+        static const char busy[] = "Server busy: too many connections. Try again later.\n";
+        send(clientSocket, busy, sizeof(busy) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+        close(clientSocket);
+        rejectedConnections++;
+        std::cerr << "Rejected client " << clientIP << ":" << ntohs(clientAddr.sin_port)
+                  << " (connection limit " << maxConnections << " reached)" << std::endl;
+        return;
+    }
+    
+    std::cout << "New client connected from " << clientIP << ":" << ntohs(clientAddr.sin_port) << std::endl;
+    
+    acceptedConnections++;
+    activeConnections++;
+    
+    // Start a new thread to handle this client
+    std::lock_guard<ProfiledMutex> lock(clientsMutex);
+    auto session = std::make_unique<ClientSession>();
+    session->socket = clientSocket;
+    session->thread = std::thread(&ElevatorServer::handleClient, this, session.get());
+    clients.emplace(nextConnectionId++, std::move(session));
+}
+
+void ElevatorServer::reapFinishedClients() {
+    std::vector<std::unique_ptr<ClientSession>> finished;
+    
+    {
+        std::lock_guard<ProfiledMutex> lock(clientsMutex);
+        for (auto it = clients.begin(); it != clients.end();) {
+            if (it->second->finished) {
+                finished.push_back(std::move(it->second));
+                it = clients.erase(it);
+            } else {
+                ++it;
+            }
         }
-        
-        // Start a new thread to handle this client
-        clientThreads.emplace_back(&ElevatorServer::handleClient, this, clientSocket);
     }
+    
+    // The threads have already returned from handleClient, so these joins are immediate
+    for (auto& session : finished) {
+        if (session->thread.joinable()) {
+            session->thread.join();
+        }
+    }
+}
+
+ElevatorServer::ClientConnection::ClientConnection(int clientSocket)
+    : socket(clientSocket), shard(0), pendingOffset(0), closing(false), watchedBus(nullptr) {
+    input.reserve(INPUT_BUFFER_SIZE);
+    output.reserve(OUTPUT_BUFFER_RESERVE);
 }
 
-void ElevatorServer::handleClient(int clientSocket) {
+void ElevatorServer::handleClient(ClientSession* session) {
+    int clientSocket = session->socket;
+    ClientConnection client(clientSocket);
+    TRACE_THREAD_NAME("client-" + std::to_string(clientSocket));
+    auto lastActivity = std::chrono::steady_clock::now();
+    
     // Welcome message
-    sendResponse(clientSocket, "Welcome to the Elevator Control System!\n"
-                              "Available commands:\n"
-                              "  call <floor> <direction>  - Request an elevator (direction: up/down)\n"
-                              "  go <floor>                - Set destination floor\n"
-                              "  stop                      - Trigger emergency stop\n"
-                              "  release                   - Release emergency stop\n"
-                              "  status                    - Get elevator statuses\n"
-                              "  exit                      - Disconnect from server\n");
-    
-    char buffer[1024];
+    sendResponse(client, "Welcome to the Elevator Control System!\n"
+                         "Available commands:\n"
+                         "  call <floor> <direction>  - Request an elevator (direction: up/down)\n"
+                         "  go <floor> [passengers]   - Set destination floor\n"
+                         "  dest <from> <to> [n]      - Destination keypad: get a car for n passengers\n"
+                         "  mode [conventional|destination] - Show or set the shard's dispatch mode\n"
+                         "  stop                      - Trigger emergency stop\n"
+                         "  release                   - Release emergency stop\n"
+                         "  status [all]              - Get elevator statuses (JSON); 'all' aggregates every shard\n"
+                         "  recent [count]            - Show the most recent events\n"
+                         "  watch / unwatch           - Start or stop streaming the shard's events\n"
+                         "  connections               - Show server connection counters\n"
+                         "  locks                     - Show lock contention profile\n"
+                         "  shard [id|name] [command] - List shards, select one, or run one command on it\n"
+                         "  trace on|off|dump         - Control span tracing / write Chrome trace\n"
+                         "  exit                      - Disconnect from server\n");
+    
+    char buffer[INPUT_BUFFER_SIZE];
     bool clientActive = true;
     
     // Set socket to non-blocking mode
     int flags = fcntl(clientSocket, F_GETFL, 0);
     fcntl(clientSocket, F_SETFL, flags | O_NONBLOCK);
     
-    while (running && clientActive) {
+    while (running && clientActive && !client.closing) {
         fd_set readFds;
         FD_ZERO(&readFds);
         FD_SET(clientSocket, &readFds);
         
+        // Only wait for writability while output is queued
+        fd_set writeFds;
+        FD_ZERO(&writeFds);
+        bool waitForWrite = client.pendingBytes() > 0;
+        if (waitForWrite) {
+            FD_SET(clientSocket, &writeFds);
+        }
+        
+        // Watched events are picked up between reads, so wake more often
         struct timeval timeout;
-        timeout.tv_sec = 1;
-        timeout.tv_usec = 0;
+        timeout.tv_sec = client.watch ? 0 : 1;
+        timeout.tv_usec = client.watch ? WATCH_POLL_INTERVAL_US : 0;
         
-        int ready = select(clientSocket + 1, &readFds, nullptr, nullptr, &timeout);
+        int ready = select(clientSocket + 1, &readFds, waitForWrite ? &writeFds : nullptr, nullptr, &timeout);
         
         if (!running) {
             break;
@@ -201,14 +345,30 @@ void ElevatorServer::handleClient(int clientSocket) {
             continue;
         }
         
+        if (client.watch) {
+            sendWatchedEvents(client);
+        }
+        
         if (ready == 0) {
-            // Timeout, no data available
+            // Timeout, no data available; a watching client is never idle
+            if (!client.watch && std::chrono::steady_clock::now() - lastActivity > idleTimeout) {
+                sendResponse(client, "Connection idle for too long. Goodbye!");
+                timedOutConnections++;
+                break;
+            }
+            continue;
+        }
+        
+        if (waitForWrite && FD_ISSET(clientSocket, &writeFds)) {
+            flushPending(client);
+        }
+        
+        if (!FD_ISSET(clientSocket, &readFds)) {
             continue;
         }
         
         // Read from client
-        memset(buffer, 0, sizeof(buffer));
-        ssize_t bytesRead = read(clientSocket, buffer, sizeof(buffer) - 1);
+        ssize_t bytesRead = read(clientSocket, buffer, sizeof(buffer));
         
         if (bytesRead <= 0) {
             // Client disconnected or error
@@ -220,8 +380,11 @@ void ElevatorServer::handleClient(int clientSocket) {
             break;
         }
         
-        // Process the command
-        std::string command(buffer, bytesRead);
+        lastActivity = std::chrono::steady_clock::now();
+        
+        // Process the command, reusing the connection's input buffer
+        std::string& command = client.input;
+        command.assign(buffer, bytesRead);
         // Remove newlines and carriage returns
         auto newEnd = std::remove(command.begin(), command.end(), '\n');
         command.erase(newEnd, command.end());
@@ -230,76 +393,127 @@ void ElevatorServer::handleClient(int clientSocket) {
         command.erase(newEnd, command.end());
         
         if (!command.empty()) {
-            processCommand(clientSocket, command);
+            processCommand(client, command);
         }
     }
     
-    // Close the socket and mark client as inactive
-    close(clientSocket);
+    stopWatching(client);
+    
+    // Give queued output (e.g. the goodbye message) one last chance to go out
+    if (!client.closing) {
+        flushPending(client);
+    }
     
+    // Close the socket and mark the session for reaping. Both happen under
+    // clientsMutex so stop() never shuts down an fd that was already reused.
     {
-        std::lock_guard<std::mutex> lock(clientsMutex);
-        activeClients.erase(clientSocket);
+        std::lock_guard<ProfiledMutex> lock(clientsMutex);
+        close(clientSocket);
+        session->finished = true;
     }
+    activeConnections--;
     
     std::cout << "Client disconnected" << std::endl;
 }
 
-void ElevatorServer::processCommand(int clientSocket, const std::string& command) {
-    // Remove debug output for cleaner terminal
-    // std::cout << "Processing command: '" << command << "' from client " << clientSocket << std::endl;
+void ElevatorServer::processCommand(ClientConnection& client, const std::string& command) {
+    // Split off the command word without allocating; only commands that take
+    // arguments construct a stream over the rest of the line
+    std::string_view line(command);
+    size_t cmdStart = line.find_first_not_of(' ');
+    if (cmdStart == std::string_view::npos) {
+        return;
+    }
+    size_t cmdEnd = line.find(' ', cmdStart);
+    std::string_view cmd = line.substr(cmdStart, cmdEnd == std::string_view::npos ? std::string_view::npos : cmdEnd - cmdStart);
+    std::string_view args = cmdEnd == std::string_view::npos ? std::string_view() : line.substr(cmdEnd);
+    
+    if (cmd == "shard") {
+        size_t idStart = args.find_first_not_of(' ');
+        if (idStart == std::string_view::npos) {
+            sendResponse(client, getShardListText(client.shard));
+            return;
+        }
+        size_t idEnd = args.find(' ', idStart);
+        std::string_view id = args.substr(idStart, idEnd == std::string_view::npos ? std::string_view::npos : idEnd - idStart);
+        
+        auto shardId = shards.findShard(id);
+        if (!shardId) {
+            sendResponse(client, "Unknown shard '" + std::string(id) + "'. Type 'shard' to list shards.");
+            return;
+        }
+        
+        size_t nestedStart = idEnd == std::string_view::npos ? idEnd : args.find_first_not_of(' ', idEnd);
+        if (nestedStart == std::string_view::npos) {
+            client.shard = *shardId;
+            sendResponse(client, "Using shard " + std::to_string(*shardId) + " (" +
+                                 shards.getShardConfig(*shardId).name + ")");
+            return;
+        }
+        
+        // Route a single command without changing the connection's shard
+        size_t previousShard = client.shard;
+        client.shard = *shardId;
+        processCommand(client, std::string(args.substr(nestedStart)));
+        client.shard = previousShard;
+        return;
+    }
     
-    std::istringstream iss(command);
-    std::string cmd;
-    iss >> cmd;
+    ElevatorController& controller = shards.getShard(client.shard);
     
     if (cmd == "call") {
+        std::istringstream iss{std::string(args)};
         int floor;
         std::string dirStr;
         
         if (iss >> floor >> dirStr) {
-            Direction dir = Direction::IDLE;
-            
-            if (dirStr == "up") {
-                dir = Direction::UP;
-            } else if (dirStr == "down") {
-                dir = Direction::DOWN;
-            } else {
-                // std::cout << "Invalid direction: " << dirStr << std::endl;
-                sendResponse(clientSocket, "Invalid direction. Use 'up' or 'down'.");
+            auto parsed = parseDirection(dirStr);
+            if (!parsed || *parsed == Direction::IDLE) {
+                sendResponse(client, "Invalid direction. Use 'up' or 'down'.");
                 return;
             }
+            Direction dir = *parsed;
             
-            // std::cout << "Adding request: floor " << floor << " direction " << dirStr << std::endl;
             if (floor < 1 || floor > controller.getNumFloors()) {
-                sendResponse(clientSocket, "Invalid floor number. Floors must be between 1 and " + std::to_string(controller.getNumFloors()));
+                sendResponse(client, "Invalid floor number. Floors must be between 1 and " + std::to_string(controller.getNumFloors()));
                 return;
             }
-            controller.addRequest(floor, 0, dir);
-            sendResponse(clientSocket, "Elevator requested at floor " + std::to_string(floor) + 
-                                      " going " + dirStr);
+            if (!controller.addRequest(floor, 0, dir)) {
+                sendResponse(client, "No elevator serves floor " + std::to_string(floor));
+                return;
+            }
+            sendResponse(client, "Elevator requested at floor " + std::to_string(floor) + 
+                                 " going " + dirStr);
         } else {
-            // std::cout << "Invalid call command format" << std::endl;
-            sendResponse(clientSocket, "Invalid command format. Use 'call <floor> <direction>'");
+            sendResponse(client, "Invalid command format. Use 'call <floor> <direction>'");
         }
     } else if (cmd == "go") {
+        std::istringstream iss{std::string(args)};
         int floor;
+        int passengers = 1;
         
         if (iss >> floor) {
+            if (!(iss >> passengers)) {
+                passengers = 1;
+            }
+            if (passengers < 1) {
+                sendResponse(client, "Invalid passenger count. Use 'go <floor> [passengers]' with at least 1 passenger.");
+                return;
+            }
             if (floor < 1 || floor > controller.getNumFloors()) {
-                sendResponse(clientSocket, "Invalid floor number. Floors must be between 1 and " + std::to_string(controller.getNumFloors()));
+                sendResponse(client, "Invalid floor number. Floors must be between 1 and " + std::to_string(controller.getNumFloors()));
                 return;
             }
             
             // Get all available elevators
-            auto statuses = controller.getElevatorStatuses();
+            controller.getElevatorStatuses(client.statusRows);
             
             // Find the best elevator to use - closest idle one
             int bestElevatorId = -1;
             int bestElevatorFloor = -1;
             int shortestDistance = std::numeric_limits<int>::max();
             
-            for (const auto& [id, currentFloor, destFloor, direction, status] : statuses) {
+            for (const auto& [id, currentFloor, destFloor, direction, status] : client.statusRows) {
                 if (status == ElevatorStatus::IDLE || status == ElevatorStatus::STOPPED) {
                     int distance = std::abs(currentFloor - floor);
                     if (distance < shortestDistance) {
@@ -312,75 +526,708 @@ void ElevatorServer::processCommand(int clientSocket, const std::string& command
             
             if (bestElevatorId >= 0) {
                 // Use the best elevator
-                controller.addRequest(bestElevatorFloor, floor, 
-                    floor > bestElevatorFloor ? Direction::UP : Direction::DOWN);
-                sendResponse(clientSocket, "Elevator #" + std::to_string(bestElevatorId) + 
-                                         " will go to floor " + std::to_string(floor));
+                if (!controller.addRequest(bestElevatorFloor, floor, 
+                        floor > bestElevatorFloor ? Direction::UP : Direction::DOWN, passengers)) {
+                    sendResponse(client, "No elevator serves both floor " + std::to_string(bestElevatorFloor) +
+                                         " and floor " + std::to_string(floor));
+                    return;
+                }
+                sendResponse(client, "Elevator #" + std::to_string(bestElevatorId) + 
+                                     " will go to floor " + std::to_string(floor));
+            } else {
+                sendResponse(client, "No idle elevator available. Try again later.");
+            }
+        } else {
+            sendResponse(client, "Invalid command format. Use 'go <floor> [passengers]'");
+        }
+    } else if (cmd == "dest") {
+        std::istringstream iss{std::string(args)};
+        int fromFloor;
+        int toFloor;
+        int passengers = 1;
+        
+        if (iss >> fromFloor >> toFloor) {
+            if (!(iss >> passengers)) {
+                passengers = 1;
+            }
+            
+            auto car = controller.addDestinationCall(fromFloor, toFloor, passengers);
+            if (!car) {
+                sendResponse(client, "Cannot take a trip from floor " + std::to_string(fromFloor) +
+                                     " to floor " + std::to_string(toFloor) + " with " +
+                                     std::to_string(passengers) + " passenger(s)");
+            } else if (*car < 0) {
+                sendResponse(client, "All cars are busy; your trip to floor " + std::to_string(toFloor) +
+                                     " is queued");
             } else {
-                sendResponse(clientSocket, "No idle elevator available. Try again later.");
+                sendResponse(client, "Take elevator #" + std::to_string(*car) + " to floor " +
+                                     std::to_string(toFloor));
             }
         } else {
-            sendResponse(clientSocket, "Invalid command format. Use 'go <floor>'");
+            sendResponse(client, "Invalid command format. Use 'dest <from> <to> [passengers]'");
         }
+    } else if (cmd == "mode") {
+        size_t modeStart = args.find_first_not_of(' ');
+        if (modeStart != std::string_view::npos) {
+            auto mode = parseDispatchMode(args.substr(modeStart, args.find(' ', modeStart) - modeStart));
+            if (!mode) {
+                sendResponse(client, "Invalid mode. Use 'mode conventional' or 'mode destination'");
+                return;
+            }
+            controller.setDispatchMode(*mode);
+        }
+        sendResponse(client, "Dispatch mode: " + std::string(toString(controller.getDispatchMode())));
     } else if (cmd == "stop") {
         controller.emergencyStop();
-        sendResponse(clientSocket, "EMERGENCY STOP activated for all elevators!");
+        sendResponse(client, "EMERGENCY STOP activated for all elevators!");
     } else if (cmd == "release") {
         controller.releaseEmergencyStop();
-        sendResponse(clientSocket, "Emergency stop released. Elevators returning to normal operation.");
+        sendResponse(client, "Emergency stop released. Elevators returning to normal operation.");
     } else if (cmd == "status") {
-        sendResponse(clientSocket, getElevatorStatusJson());
+        client.output.clear();
+        size_t scopeStart = args.find_first_not_of(' ');
+        if (scopeStart != std::string_view::npos && args.substr(scopeStart, 3) == "all") {
+            writeShardedStatusJson(client.output, client.statusRows);
+        } else {
+            writeElevatorStatusJson(client.output, controller, client.statusRows);
+        }
+        sendResponse(client, client.output);
+    } else if (cmd == "recent") {
+        std::istringstream iss{std::string(args)};
+        int count = 10;
+        if (!(iss >> count)) {
+            count = 10;
+        }
+        if (count < 1) {
+            sendResponse(client, "Invalid count. Use 'recent [count]' with a positive count.");
+            return;
+        }
+        sendResponse(client, getRecentEventsText(controller, count));
+    } else if (cmd == "watch") {
+        stopWatching(client);
+        client.watchedBus = &controller.getEventBus();
+        client.watch = client.watchedBus->subscribe();
+        sendResponse(client, "Watching events on shard " + std::to_string(client.shard) +
+                             ". Type 'unwatch' to stop.");
+    } else if (cmd == "unwatch") {
+        if (!client.watch) {
+            sendResponse(client, "Not watching events");
+            return;
+        }
+        stopWatching(client);
+        sendResponse(client, "Stopped watching events");
+    } else if (cmd == "connections") {
+        ConnectionStats stats = getConnectionStats();
+        sendResponse(client, "Connections: active=" + std::to_string(stats.active) +
+                             " accepted=" + std::to_string(stats.accepted) +
+                             " rejected=" + std::to_string(stats.rejected) +
+                             " timed_out=" + std::to_string(stats.timedOut));
+    } else if (cmd == "locks") {
+        sendResponse(client, LockProfiler::instance().formatReport());
+    } else if (cmd == "trace") {
+        std::istringstream iss{std::string(args)};
+        std::string action;
+        iss >> action;
+        
+        Tracer& tracer = Tracer::instance();
+        if (action == "on") {
+            tracer.setEnabled(true);
+            sendResponse(client, "Tracing enabled");
+        } else if (action == "off") {
+            tracer.setEnabled(false);
+            sendResponse(client, "Tracing disabled");
+        } else if (action == "dump") {
+            long spans = tracer.dump();
+            if (spans < 0) {
+                sendResponse(client, "Failed to write trace to " + tracer.getOutputPath());
+            } else {
+                sendResponse(client, "Wrote " + std::to_string(spans) + " spans to " + tracer.getOutputPath());
+            }
+        } else {
+            sendResponse(client, "Invalid command format. Use 'trace on', 'trace off' or 'trace dump'");
+        }
     } else if (cmd == "exit") {
-        sendResponse(clientSocket, "Goodbye!");
+        sendResponse(client, "Goodbye!");
         return;
     } else {
-        sendResponse(clientSocket, "Unknown command '" + cmd + "'. Type 'help' for available commands.");
+        sendResponse(client, "Unknown command '" + std::string(cmd) + "'. Type 'help' for available commands.");
     }
 }
 
-void ElevatorServer::sendResponse(int clientSocket, const std::string& response) {
-    std::string fullResponse = response + "\n";
-    // Remove debug output for cleaner terminal
-    // std::cout << "Sending response to client " << clientSocket << ": " << response << std::endl;
-    ssize_t bytesSent = write(clientSocket, fullResponse.c_str(), fullResponse.length());
-    if (bytesSent < 0) {
-        std::cerr << "Error sending response: " << strerror(errno) << std::endl;
-    } 
-    // else {
-    //     std::cout << "Sent " << bytesSent << " bytes to client " << clientSocket << std::endl;
-    // }
+void ElevatorServer::sendResponse(ClientConnection& client, std::string_view response) {
+    if (client.closing) {
+        return;
+    }
+    
+    // Anything already queued must go out first to keep replies in order
+    if (client.pendingBytes() > 0) {
+        client.pending.append(response.data(), response.size());
+        client.pending.push_back('\n');
+        flushPending(client);
+    } else {
+        // Gather the payload and its line terminator into one syscall instead
+        // of copying them into a single string
+        static const char newline = '\n';
+        struct iovec parts[2];
+        parts[0].iov_base = const_cast<char*>(response.data());
+        parts[0].iov_len = response.size();
+        parts[1].iov_base = const_cast<char*>(&newline);
+        parts[1].iov_len = 1;
+        
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = parts;
+        message.msg_iovlen = 2;
+        
+        ssize_t bytesSent = sendmsg(client.socket, &message, MSG_NOSIGNAL);
+        if (bytesSent < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::cerr << "Error sending response: " << strerror(errno) << std::endl;
+                client.closing = true;
+                return;
+            }
+            bytesSent = 0;
+        }
+        
+        // Queue whatever the kernel did not accept (short write or EAGAIN)
+        size_t sent = static_cast<size_t>(bytesSent);
+        if (sent < response.size()) {
+            client.pending.append(response.data() + sent, response.size() - sent);
+            client.pending.push_back('\n');
+        } else if (sent == response.size()) {
+            client.pending.push_back('\n');
+        }
+    }
+    
+    if (client.pendingBytes() > SEND_HIGH_WATER_MARK) {
+        std::cerr << "Client " << client.socket << " is not reading its responses ("
+                  << client.pendingBytes() << " bytes queued), disconnecting" << std::endl;
+        client.closing = true;
+    }
 }
 
-std::string ElevatorServer::getElevatorStatusJson() const {
-    std::ostringstream oss;
-    auto statuses = controller.getElevatorStatuses();
+void ElevatorServer::sendWatchedEvents(ClientConnection& client) {
+    EventRecord event;
+    while (!client.closing && client.watch->poll(event)) {
+        client.output.assign("EVENT ");
+        client.output.append(formatEventRecord(event));
+        sendResponse(client, client.output);
+    }
+}
+
+void ElevatorServer::stopWatching(ClientConnection& client) {
+    if (client.watch) {
+        client.watchedBus->unsubscribe(client.watch);
+        client.watch.reset();
+        client.watchedBus = nullptr;
+    }
+}
+
+void ElevatorServer::flushPending(ClientConnection& client) {
+    while (client.pendingBytes() > 0) {
+        ssize_t bytesSent = send(client.socket, client.pending.data() + client.pendingOffset,
+                                 client.pendingBytes(), MSG_NOSIGNAL);
+        if (bytesSent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "Error sending response: " << strerror(errno) << std::endl;
+                client.closing = true;
+            }
+            break;
+        }
+        client.pendingOffset += static_cast<size_t>(bytesSent);
+    }
     
-    oss << "Elevator Statuses:\n";
-    oss << "ID | Current Floor | Destination | Direction | Status\n";
-    oss << "----------------------------------------------------\n";
+    if (client.pendingBytes() == 0) {
+        // Keep the capacity for the next backlog
+        client.pending.clear();
+        client.pendingOffset = 0;
+    } else if (client.pendingOffset > client.pending.size() / 2) {
+        // Drop the sent prefix so a client that never fully drains cannot grow the buffer
+        client.pending.erase(0, client.pendingOffset);
+        client.pendingOffset = 0;
+    }
+}
+
+// Append a number without going through a temporary std::string
+template <typename T>
+static void appendNumber(std::string& out, T value) {
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+// Append the "elevators" array for a set of status rows
+static void appendElevatorArray(std::string& out, const std::vector<ElevatorStatusRow>& rows) {
+    out.append("\"elevators\":[");
     
-    for (const auto& [id, currentFloor, destFloor, direction, status] : statuses) {
-        std::string dirStr;
-        switch (direction) {
-            case Direction::IDLE: dirStr = "Idle"; break;
-            case Direction::UP: dirStr = "Up"; break;
-            case Direction::DOWN: dirStr = "Down"; break;
+    bool first = true;
+    for (const auto& [id, currentFloor, destFloor, direction, status] : rows) {
+        if (!first) {
+            out.push_back(',');
         }
+        first = false;
+        
+        out.append("{\"id\":");
+        appendNumber(out, id);
+        out.append(",\"currentFloor\":");
+        appendNumber(out, currentFloor);
+        out.append(",\"destinationFloor\":");
+        if (direction == Direction::IDLE) {
+            out.append("null");
+        } else {
+            appendNumber(out, destFloor);
+        }
+        out.append(",\"direction\":\"");
+        out.append(toString(direction));
+        out.append("\",\"status\":\"");
+        out.append(toString(status));
+        out.append("\"}");
+    }
+    
+    out.push_back(']');
+}
+
+void ElevatorServer::writeElevatorStatusJson(std::string& out, const ElevatorController& controller,
+                                             std::vector<ElevatorStatusRow>& rows) const {
+    controller.getElevatorStatuses(rows);
+    
+    out.push_back('{');
+    appendElevatorArray(out, rows);
+    out.push_back('}');
+}
+
+void ElevatorServer::writeShardedStatusJson(std::string& out, std::vector<ElevatorStatusRow>& rows) const {
+    size_t totalElevators = 0;
+    size_t moving = 0;
+    size_t emergency = 0;
+    size_t pending = 0;
+    
+    out.append("{\"shards\":[");
+    for (size_t shardId = 0; shardId < shards.getShardCount(); shardId++) {
+        const ElevatorController& controller = shards.getShard(shardId);
+        const ShardConfig& config = shards.getShardConfig(shardId);
+        controller.getElevatorStatuses(rows);
+        size_t shardPending = controller.getPendingRequestCount();
         
-        std::string statusStr;
-        switch (status) {
-            case ElevatorStatus::IDLE: statusStr = "Idle"; break;
-            case ElevatorStatus::MOVING: statusStr = "Moving"; break;
-            case ElevatorStatus::STOPPED: statusStr = "Stopped"; break;
-            case ElevatorStatus::EMERGENCY: statusStr = "EMERGENCY"; break;
+        for (const auto& row : rows) {
+            ElevatorStatus status = std::get<4>(row);
+            moving += status == ElevatorStatus::MOVING;
+            emergency += status == ElevatorStatus::EMERGENCY;
         }
+        totalElevators += rows.size();
+        pending += shardPending;
         
-        oss << id << " | " 
-            << currentFloor << " | " 
-            << (direction == Direction::IDLE ? "--" : std::to_string(destFloor)) << " | "
-            << dirStr << " | " 
-            << statusStr << "\n";
+        if (shardId > 0) {
+            out.push_back(',');
+        }
+        out.append("{\"id\":");
+        appendNumber(out, shardId);
+        // Shard names come from --shards and cannot contain ',' or ':'; they
+        // are not otherwise escaped
+        out.append(",\"name\":\"").append(config.name);
+        out.append("\",\"floors\":");
+        appendNumber(out, config.floors);
+        out.append(",\"pendingRequests\":");
+        appendNumber(out, shardPending);
+        out.push_back(',');
+        appendElevatorArray(out, rows);
+        out.push_back('}');
+    }
+    
+    out.append("],\"totals\":{\"shards\":");
+    appendNumber(out, shards.getShardCount());
+    out.append(",\"elevators\":");
+    appendNumber(out, totalElevators);
+    out.append(",\"moving\":");
+    appendNumber(out, moving);
+    out.append(",\"emergency\":");
+    appendNumber(out, emergency);
+    out.append(",\"pendingRequests\":");
+    appendNumber(out, pending);
+    out.append("}}");
+}
+
+std::string ElevatorServer::getShardListText(size_t currentShard) const {
+    std::ostringstream oss;
+    oss << "Shards:\n";
+    for (size_t shardId = 0; shardId < shards.getShardCount(); shardId++) {
+        const ShardConfig& config = shards.getShardConfig(shardId);
+        oss << (shardId == currentShard ? "* " : "  ") << shardId << " " << config.name
+            << " elevators=" << config.elevators << " floors=" << config.floors << "\n";
+    }
+    return oss.str();
+}
+
+std::string ElevatorServer::getRecentEventsText(ElevatorController& controller, int count) {
+    std::ostringstream oss;
+    auto events = controller.getRecentEvents(count);
+    
+    oss << "Recent Events:\n";
+    for (const auto& event : events) {
+        oss << formatEventRecord(event) << "\n";
+    }
+    
+    // Only go to the database for history older than what the ring holds. The
+    // ring also has events the database never got (floors passed, an outage),
+    // so rows are matched by time rather than by count.
+    int remaining = count - static_cast<int>(events.size());
+    if (remaining > 0) {
+        auto before = std::chrono::system_clock::time_point::max();
+        if (!events.empty()) {
+            before = std::chrono::system_clock::time_point(std::chrono::milliseconds(events.back().timestampMs));
+        }
+        for (const auto& [timestamp, eventType, elevatorId, fromFloor, toFloor] :
+             controller.getLoggedEvents(remaining, before)) {
+            oss << timestamp << " " << eventType
+                << " elevator=" << elevatorId
+                << " from=" << fromFloor
+                << " to=" << toFloor << " (db)\n";
+        }
     }
     
     return oss.str();
-} 
\ No newline at end of file
+}
+
+void ElevatorServer::handleHttpClient() {
+    int httpClient = accept(httpSocket, nullptr, nullptr);
+    if (httpClient < 0) {
+        std::cerr << "Error accepting metrics connection: " << strerror(errno) << std::endl;
+        return;
+    }
+    
+    // Requests are served inline on the server thread, so a misbehaving
+    // scraper may hold it for one deadline in total, however it trickles data
+    const auto deadline = std::chrono::steady_clock::now() + HTTP_REQUEST_DEADLINE;
+    auto waitReady = [httpClient, deadline](short events) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) {
+            return false;
+        }
+        struct pollfd ready = {httpClient, events, 0};
+        return poll(&ready, 1, static_cast<int>(remaining.count())) > 0;
+    };
+    
+    // Read until the end of the request headers; bodies are not supported
+    httpRequest.clear();
+    char buffer[INPUT_BUFFER_SIZE];
+    while (httpRequest.size() < HTTP_MAX_REQUEST_SIZE &&
+           httpRequest.find("\r\n\r\n") == std::string::npos) {
+        if (!waitReady(POLLIN)) {
+            // Too slow to send even the request; no answer
+            close(httpClient);
+            return;
+        }
+        ssize_t bytesRead = recv(httpClient, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (bytesRead <= 0) {
+            break;
+        }
+        httpRequest.append(buffer, bytesRead);
+    }
+    
+    // Request line: METHOD SP PATH SP VERSION
+    std::string_view requestLine(httpRequest);
+    requestLine = requestLine.substr(0, requestLine.find("\r\n"));
+    size_t methodEnd = requestLine.find(' ');
+    size_t pathEnd = methodEnd == std::string_view::npos ? std::string_view::npos : requestLine.find(' ', methodEnd + 1);
+    std::string_view method = requestLine.substr(0, methodEnd);
+    std::string_view path;
+    if (pathEnd != std::string_view::npos) {
+        path = requestLine.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+        path = path.substr(0, path.find('?'));
+    }
+    
+    httpBody.clear();
+    std::string_view statusLine = "200 OK";
+    std::string_view contentType = "text/plain; charset=utf-8";
+    
+    if (method != "GET") {
+        statusLine = "405 Method Not Allowed";
+        httpBody.append("Only GET is supported\n");
+    } else if (path == "/metrics") {
+        contentType = "text/plain; version=0.0.4; charset=utf-8";
+        writePrometheusMetrics(httpBody);
+    } else if (path == "/status") {
+        contentType = "application/json";
+        writeShardedStatusJson(httpBody, httpStatusRows);
+        httpBody.push_back('\n');
+    } else {
+        statusLine = "404 Not Found";
+        httpBody.append("Available endpoints: /metrics, /status\n");
+    }
+    
+    httpResponse.clear();
+    httpResponse.append("HTTP/1.1 ");
+    httpResponse.append(statusLine);
+    httpResponse.append("\r\nContent-Type: ");
+    httpResponse.append(contentType);
+    httpResponse.append("\r\nContent-Length: ");
+    appendNumber(httpResponse, httpBody.size());
+    httpResponse.append("\r\nConnection: close\r\n\r\n");
+    httpResponse.append(httpBody);
+    
+    size_t sent = 0;
+    while (sent < httpResponse.size() && waitReady(POLLOUT)) {
+        ssize_t bytesSent = send(httpClient, httpResponse.data() + sent, httpResponse.size() - sent,
+                                 MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (bytesSent <= 0) {
+            if (bytesSent < 0 && (errno == EINTR || errno == EAGAIN)) {
+                continue;
+            }
+            break;
+        }
+        sent += static_cast<size_t>(bytesSent);
+    }
+    
+    close(httpClient);
+}
+
+// Emit the samples of one histogram series with cumulative buckets. labels is
+// either empty or a comma-free list such as lock="name" added to every sample.
+static void appendHistogramSamples(std::string& out, std::string_view name, std::string_view labels,
+                                   const LatencyHistogram::Snapshot& snapshot) {
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < LatencyHistogram::NUM_BUCKETS; i++) {
+        cumulative += snapshot.buckets[i];
+        out.append(name).append("_bucket{");
+        if (!labels.empty()) {
+            out.append(labels).push_back(',');
+        }
+        out.append("le=\"");
+        if (i < LatencyHistogram::BUCKET_BOUNDS_US.size()) {
+            appendNumber(out, static_cast<double>(LatencyHistogram::BUCKET_BOUNDS_US[i]) / 1e6);
+        } else {
+            out.append("+Inf");
+        }
+        out.append("\"} ");
+        appendNumber(out, cumulative);
+        out.push_back('\n');
+    }
+    
+    out.append(name).append("_sum");
+    if (!labels.empty()) {
+        out.append("{").append(labels).append("}");
+    }
+    out.push_back(' ');
+    appendNumber(out, static_cast<double>(snapshot.sumNanos) / 1e9);
+    out.push_back('\n');
+    out.append(name).append("_count");
+    if (!labels.empty()) {
+        out.append("{").append(labels).append("}");
+    }
+    out.push_back(' ');
+    appendNumber(out, snapshot.count);
+    out.push_back('\n');
+}
+
+// Emit a metric family header for a per-car series
+static void appendFamilyHeader(std::string& out, std::string_view name, std::string_view type, std::string_view help) {
+    out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+    out.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+}
+
+// Emit a single unlabelled sample
+template <typename T>
+static void appendSample(std::string& out, std::string_view name, std::string_view type,
+                         std::string_view help, T value) {
+    appendFamilyHeader(out, name, type, help);
+    out.append(name).push_back(' ');
+    appendNumber(out, value);
+    out.push_back('\n');
+}
+
+void ElevatorServer::writePrometheusMetrics(std::string& out) {
+    // Per-car series, one family at a time as the exposition format requires
+    struct CarSeries {
+        std::string_view name;
+        std::string_view type;
+        std::string_view help;
+        uint64_t (*value)(const ElevatorMetrics&);
+    };
+    static const CarSeries carSeries[] = {
+        {"elevator_trips_total", "counter", "Trips completed by each car.",
+         [](const ElevatorMetrics& m) { return m.trips; }},
+        {"elevator_floors_travelled_total", "counter", "Floors travelled by each car.",
+         [](const ElevatorMetrics& m) { return m.floorsTravelled; }},
+        {"elevator_door_cycles_total", "counter", "Door open/close cycles of each car.",
+         [](const ElevatorMetrics& m) { return m.doorCycles; }},
+        {"elevator_queue_depth", "gauge", "Requests queued on each car.",
+         [](const ElevatorMetrics& m) { return static_cast<uint64_t>(m.queueDepth); }},
+        {"elevator_load_passengers", "gauge", "Passengers on board each car.",
+         [](const ElevatorMetrics& m) { return static_cast<uint64_t>(m.load); }},
+        {"elevator_capacity_passengers", "gauge", "Passenger capacity of each car.",
+         [](const ElevatorMetrics& m) { return static_cast<uint64_t>(m.capacity); }},
+        {"elevator_passengers_delivered_total", "counter", "Passengers dropped off by each car.",
+         [](const ElevatorMetrics& m) { return m.passengersDelivered; }},
+    };
+    
+    for (const auto& series : carSeries) {
+        appendFamilyHeader(out, series.name, series.type, series.help);
+        for (size_t shardId = 0; shardId < shards.getShardCount(); shardId++) {
+            shards.getShard(shardId).getElevatorMetrics(httpMetricsRows);
+            for (const auto& car : httpMetricsRows) {
+                out.append(series.name).append("{shard=\"").append(shards.getShardConfig(shardId).name);
+                out.append("\",car=\"");
+                appendNumber(out, car.id);
+                out.append("\"} ");
+                appendNumber(out, series.value(car));
+                out.push_back('\n');
+            }
+        }
+    }
+    
+    appendFamilyHeader(out, "elevator_pending_requests", "gauge", "Requests waiting for each shard's dispatcher.");
+    for (size_t shardId = 0; shardId < shards.getShardCount(); shardId++) {
+        out.append("elevator_pending_requests{shard=\"").append(shards.getShardConfig(shardId).name).append("\"} ");
+        appendNumber(out, shards.getShard(shardId).getPendingRequestCount());
+        out.push_back('\n');
+    }
+    
+    appendFamilyHeader(out, "elevator_handling_capacity_5m", "gauge",
+                       "Passengers delivered by each shard in the last 5 minutes.");
+    for (size_t shardId = 0; shardId < shards.getShardCount(); shardId++) {
+        out.append("elevator_handling_capacity_5m{shard=\"").append(shards.getShardConfig(shardId).name).append("\"} ");
+        appendNumber(out, shards.getShard(shardId).getHandlingCapacity());
+        out.push_back('\n');
+    }
+    
+    appendFamilyHeader(out, "elevator_destination_grouped_total", "counter",
+                       "Destination calls that joined a trip already assigned to a car.");
+    for (size_t shardId = 0; shardId < shards.getShardCount(); shardId++) {
+        out.append("elevator_destination_grouped_total{shard=\"").append(shards.getShardConfig(shardId).name).append("\"} ");
+        appendNumber(out, shards.getShard(shardId).getGroupedRequestCount());
+        out.push_back('\n');
+    }
+    
+    appendFamilyHeader(out, "elevator_calls_reassigned_total", "counter",
+                       "Queued calls moved to a car that could reach the pickup sooner.");
+    for (size_t shardId = 0; shardId < shards.getShardCount(); shardId++) {
+        out.append("elevator_calls_reassigned_total{shard=\"").append(shards.getShardConfig(shardId).name).append("\"} ");
+        appendNumber(out, shards.getShard(shardId).getReassignedRequestCount());
+        out.push_back('\n');
+    }
+    
+    appendFamilyHeader(out, "elevator_parking_moves_total", "counter",
+                       "Idle cars sent to wait at a floor where calls are expected.");
+    for (size_t shardId = 0; shardId < shards.getShardCount(); shardId++) {
+        out.append("elevator_parking_moves_total{shard=\"").append(shards.getShardConfig(shardId).name).append("\"} ");
+        appendNumber(out, shards.getShard(shardId).getParkingMoveCount());
+        out.push_back('\n');
+    }
+    
+    // Events held back while the database was unreachable
+    struct DatabaseCounter {
+        std::string_view name;
+        std::string_view help;
+        uint64_t EventSink::EventCounters::*value;
+    };
+    static const DatabaseCounter databaseCounters[] = {
+        {"elevator_db_events_spilled_total", "Events logged while the database was unreachable.",
+         &EventSink::EventCounters::spilled},
+        {"elevator_db_events_replayed_total", "Buffered events written after the database came back.",
+         &EventSink::EventCounters::replayed},
+        {"elevator_db_events_dropped_total", "Events lost to the sink queue, buffer and spill file bounds.",
+         &EventSink::EventCounters::dropped},
+        {"elevator_db_reconnects_total", "Database connections re-established after a loss.",
+         &EventSink::EventCounters::reconnects},
+    };
+    
+    std::vector<EventSink::EventCounters> shardCounters;
+    for (size_t shardId = 0; shardId < shards.getShardCount(); shardId++) {
+        shardCounters.push_back(shards.getShard(shardId).getDatabaseEventCounters());
+    }
+    for (const auto& counter : databaseCounters) {
+        appendFamilyHeader(out, counter.name, "counter", counter.help);
+        for (size_t shardId = 0; shardId < shards.getShardCount(); shardId++) {
+            out.append(counter.name).append("{shard=\"").append(shards.getShardConfig(shardId).name).append("\"} ");
+            appendNumber(out, shardCounters[shardId].*counter.value);
+            out.push_back('\n');
+        }
+    }
+    
+    appendFamilyHeader(out, "elevator_db_events_buffered", "gauge",
+                       "Events waiting in memory or the spill file for the database.");
+    for (size_t shardId = 0; shardId < shards.getShardCount(); shardId++) {
+        out.append("elevator_db_events_buffered{shard=\"").append(shards.getShardConfig(shardId).name).append("\"} ");
+        appendNumber(out, shards.getShard(shardId).getBufferedDatabaseEvents());
+        out.push_back('\n');
+    }
+    
+    appendFamilyHeader(out, "elevator_events_total", "counter", "Events published on each shard's event bus.");
+    for (size_t shardId = 0; shardId < shards.getShardCount(); shardId++) {
+        const EventBus& bus = shards.getShard(shardId).getEventBus();
+        for (size_t type = 0; type < LOG_EVENT_TYPE_NAMES.size(); type++) {
+            out.append("elevator_events_total{shard=\"").append(shards.getShardConfig(shardId).name);
+            out.append("\",type=\"").append(LOG_EVENT_TYPE_NAMES[type]).append("\"} ");
+            appendNumber(out, bus.getPublishedCount(static_cast<LogEventType>(type)));
+            out.push_back('\n');
+        }
+    }
+    
+    appendFamilyHeader(out, "elevator_event_bus_dropped_total", "counter",
+                       "Events dropped because a subscriber's queue was full.");
+    for (size_t shardId = 0; shardId < shards.getShardCount(); shardId++) {
+        out.append("elevator_event_bus_dropped_total{shard=\"").append(shards.getShardConfig(shardId).name).append("\"} ");
+        appendNumber(out, shards.getShard(shardId).getEventBus().getDroppedCount());
+        out.push_back('\n');
+    }
+    
+    // Dispatcher and database histograms, one labelled series per shard
+    struct ShardHistogram {
+        std::string_view name;
+        std::string_view help;
+        LatencyHistogram::Snapshot (ElevatorController::*snapshot)() const;
+    };
+    static const ShardHistogram shardHistograms[] = {
+        {"elevator_dispatch_queue_wait_seconds", "Time requests wait before the dispatcher picks them up.",
+         &ElevatorController::getQueueWaitLatency},
+        {"elevator_dispatch_duration_seconds", "Time spent choosing a car and handing it a request.",
+         &ElevatorController::getDispatchLatency},
+        {"elevator_db_write_duration_seconds", "Time spent executing and committing database writes.",
+         &ElevatorController::getDatabaseWriteLatency},
+    };
+    
+    std::string labels;
+    for (const auto& histogram : shardHistograms) {
+        appendFamilyHeader(out, histogram.name, "histogram", histogram.help);
+        for (size_t shardId = 0; shardId < shards.getShardCount(); shardId++) {
+            labels.assign("shard=\"").append(shards.getShardConfig(shardId).name).append("\"");
+            appendHistogramSamples(out, histogram.name, labels, (shards.getShard(shardId).*histogram.snapshot)());
+        }
+    }
+    
+    ConnectionStats stats = getConnectionStats();
+    appendSample(out, "elevator_server_connections_active", "gauge",
+                 "Connected command clients.", stats.active);
+    appendSample(out, "elevator_server_connections_accepted_total", "counter",
+                 "Command connections accepted.", stats.accepted);
+    appendSample(out, "elevator_server_connections_rejected_total", "counter",
+                 "Command connections rejected at the connection limit.", stats.rejected);
+    appendSample(out, "elevator_server_connections_timed_out_total", "counter",
+                 "Command connections closed for being idle.", stats.timedOut);
+    
+    // Lock profiles, one labelled series per named mutex
+    auto locks = LockProfiler::instance().report();
+    appendFamilyHeader(out, "elevator_lock_contended_total", "counter",
+                       "Lock acquisitions that had to wait for another holder.");
+    for (const auto& lock : locks) {
+        out.append("elevator_lock_contended_total{lock=\"").append(lock.name).append("\"} ");
+        appendNumber(out, lock.contended);
+        out.push_back('\n');
+    }
+    
+    appendFamilyHeader(out, "elevator_lock_wait_seconds", "histogram",
+                       "Time spent acquiring each named lock.");
+    for (const auto& lock : locks) {
+        labels.assign("lock=\"").append(lock.name).append("\"");
+        appendHistogramSamples(out, "elevator_lock_wait_seconds", labels, lock.wait);
+    }
+    appendFamilyHeader(out, "elevator_lock_hold_seconds", "histogram",
+                       "Time each named lock is held per acquisition.");
+    for (const auto& lock : locks) {
+        labels.assign("lock=\"").append(lock.name).append("\"");
+        appendHistogramSamples(out, "elevator_lock_hold_seconds", labels, lock.hold);
+    }
+}
@@ -0,0 +1,189 @@
+#include "EventBus.h"
+#include <algorithm>
+#include <thread>
+
+EventSubscription::EventSubscription(uint32_t typeMask, size_t minCapacity)
+    : capacity(1), typeMask(typeMask), tail(0), head(0), dropped(0),
+      consumerWaiting(false), woken(false) {
+    while (capacity < minCapacity) {
+        capacity <<= 1;
+    }
+    mask = capacity - 1;
+    slots = std::make_unique<Slot[]>(capacity);
+    
+    // Slot i is free for the publisher holding ticket i
+    for (size_t i = 0; i < capacity; i++) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool EventSubscription::push(const EventRecord& record) {
+    // Bounded multi-producer queue: a slot whose sequence equals our ticket
+    // is free; claiming the ticket with a CAS gives us exclusive use of it
+    uint64_t ticket = tail.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &slots[ticket & mask];
+        uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        int64_t lag = static_cast<int64_t>(sequence - ticket);
+        
+        if (lag == 0) {
+            if (tail.compare_exchange_weak(ticket, ticket + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (lag < 0) {
+            // The consumer has not freed this slot yet: the queue is full
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            ticket = tail.load(std::memory_order_relaxed);
+        }
+    }
+    
+    slot->record = record;
+    slot->sequence.store(ticket + 1, std::memory_order_release);
+    
+    // Pairs with the fence in waitFor(): either we see the consumer parked,
+    // or it sees our event before parking
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (consumerWaiting.load(std::memory_order_relaxed)) {
+        std::lock_guard<ProfiledMutex> lock(waitMutex);
+        waitCV.notify_one();
+    }
+    return true;
+}
+
+bool EventSubscription::hasEvents() const {
+    return slots[head & mask].sequence.load(std::memory_order_acquire) == head + 1;
+}
+
+bool EventSubscription::poll(EventRecord& out) {
+    Slot& slot = slots[head & mask];
+    if (slot.sequence.load(std::memory_order_acquire) != head + 1) {
+        return false;
+    }
+    
+    out = slot.record;
+    // Hand the slot to the publisher one lap ahead
+    slot.sequence.store(head + capacity, std::memory_order_release);
+    head++;
+    return true;
+}
+
+bool EventSubscription::waitFor(std::chrono::milliseconds timeout) {
+    if (hasEvents()) {
+        return true;
+    }
+    
+    std::unique_lock<ProfiledMutex> lock(waitMutex);
+    consumerWaiting.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    waitCV.wait_for(lock, timeout, [this] { return hasEvents() || woken.load(std::memory_order_relaxed); });
+    consumerWaiting.store(false, std::memory_order_relaxed);
+    woken.store(false, std::memory_order_relaxed);
+    return hasEvents();
+}
+
+void EventSubscription::wake() {
+    std::lock_guard<ProfiledMutex> lock(waitMutex);
+    woken.store(true, std::memory_order_relaxed);
+    waitCV.notify_one();
+}
+
+uint64_t EventSubscription::getDropped() const {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+EventBus::EventBus(size_t historyCapacity)
+    : history(historyCapacity), subscribers(new SubscriberList()), readerEpoch(0), retiredDrops(0) {
+}
+
+EventBus::~EventBus() {
+    delete subscribers.load();
+}
+
+void EventBus::replaceSubscribers(const SubscriberList* updated) {
+    const SubscriberList* previous = subscribers.exchange(updated);
+    
+    // A publisher that may still hold previous counted itself before this
+    // exchange, in one of the two slots. Wait out both.
+    for (int flip = 0; flip < 2; flip++) {
+        unsigned draining = readerEpoch.fetch_xor(1);
+        while (readers[draining].count.load() != 0) {
+            std::this_thread::yield();
+        }
+    }
+    delete previous;
+}
+
+std::shared_ptr<EventSubscription> EventBus::subscribe(uint32_t typeMask, size_t queueCapacity) {
+    auto subscription = std::make_shared<EventSubscription>(typeMask, queueCapacity);
+    
+    std::lock_guard<ProfiledMutex> lock(subscribeMutex);
+    auto updated = std::make_unique<SubscriberList>(*subscribers.load());
+    updated->push_back(subscription);
+    replaceSubscribers(updated.release());
+    return subscription;
+}
+
+void EventBus::unsubscribe(const std::shared_ptr<EventSubscription>& subscription) {
+    std::lock_guard<ProfiledMutex> lock(subscribeMutex);
+    auto updated = std::make_unique<SubscriberList>(*subscribers.load());
+    auto removed = std::remove(updated->begin(), updated->end(), subscription);
+    if (removed == updated->end()) {
+        return;
+    }
+    
+    updated->erase(removed, updated->end());
+    replaceSubscribers(updated.release());
+    retiredDrops.fetch_add(subscription->getDropped(), std::memory_order_relaxed);
+}
+
+void EventBus::publish(LogEventType type, int elevatorId, int fromFloor, int toFloor) {
+    history.push(type, elevatorId, fromFloor, toFloor);
+    publishedByType[static_cast<size_t>(type)].fetch_add(1, std::memory_order_relaxed);
+    
+    // Sequentially consistent, so a writer's wait sees this count or this
+    // load sees the writer's new list
+    ReaderCount& reader = readers[readerEpoch.load()];
+    reader.count.fetch_add(1);
+    const SubscriberList* current = subscribers.load();
+    
+    if (!current->empty()) {
+        EventRecord record;
+        record.timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        record.type = type;
+        record.elevatorId = elevatorId;
+        record.fromFloor = fromFloor;
+        record.toFloor = toFloor;
+        
+        for (const auto& subscription : *current) {
+            if (subscription->wants(type)) {
+                subscription->push(record);
+            }
+        }
+    }
+    reader.count.fetch_sub(1, std::memory_order_release);
+}
+
+size_t EventBus::getRecent(std::vector<EventRecord>& out, size_t limit) const {
+    return history.snapshot(out, limit);
+}
+
+size_t EventBus::getHistoryCapacity() const {
+    return history.getCapacity();
+}
+
+uint64_t EventBus::getPublishedCount(LogEventType type) const {
+    return publishedByType[static_cast<size_t>(type)].load(std::memory_order_relaxed);
+}
+
+uint64_t EventBus::getDroppedCount() const {
+    std::lock_guard<ProfiledMutex> lock(subscribeMutex);
+    uint64_t total = retiredDrops.load(std::memory_order_relaxed);
+    for (const auto& subscription : *subscribers.load()) {
+        total += subscription->getDropped();
+    }
+    return total;
+}
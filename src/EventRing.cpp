@@ -0,0 +1,97 @@
+#include "EventRing.h"
+#include "EnumStrings.h"
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <thread>
+
+EventRing::EventRing(size_t minCapacity)
+    : capacity(1), nextIndex(0) {
+    while (capacity < minCapacity) {
+        capacity <<= 1;
+    }
+    mask = capacity - 1;
+    slots = std::make_unique<Slot[]>(capacity);
+}
+
+void EventRing::push(LogEventType type, int elevatorId, int fromFloor, int toFloor) {
+    auto now = std::chrono::system_clock::now();
+    int64_t timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        now.time_since_epoch()).count();
+    
+    uint64_t index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots[index & mask];
+    
+    // Sequence numbers are 2*index+1 while writing and 2*index+2 once published.
+    // Wait for the writer one lap behind us to finish with this slot.
+    uint64_t previous = index < capacity ? 0 : 2 * (index - capacity) + 2;
+    while (slot.sequence.load(std::memory_order_acquire) != previous) {
+        std::this_thread::yield();
+    }
+    
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    slot.timestampMs.store(timestampMs, std::memory_order_relaxed);
+    slot.type.store(static_cast<int>(type), std::memory_order_relaxed);
+    slot.elevatorId.store(elevatorId, std::memory_order_relaxed);
+    slot.fromFloor.store(fromFloor, std::memory_order_relaxed);
+    slot.toFloor.store(toFloor, std::memory_order_relaxed);
+    
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+size_t EventRing::snapshot(std::vector<EventRecord>& out, size_t limit) const {
+    out.clear();
+    
+    uint64_t end = nextIndex.load(std::memory_order_acquire);
+    uint64_t begin = end > capacity ? end - capacity : 0;
+    
+    for (uint64_t index = end; index > begin && out.size() < limit; index--) {
+        const Slot& slot = slots[(index - 1) & mask];
+        uint64_t expected = 2 * (index - 1) + 2;
+        
+        if (slot.sequence.load(std::memory_order_acquire) != expected) {
+            // Still being written or already overwritten by a newer lap
+            continue;
+        }
+        
+        EventRecord record;
+        record.timestampMs = slot.timestampMs.load(std::memory_order_relaxed);
+        record.type = static_cast<LogEventType>(slot.type.load(std::memory_order_relaxed));
+        record.elevatorId = slot.elevatorId.load(std::memory_order_relaxed);
+        record.fromFloor = slot.fromFloor.load(std::memory_order_relaxed);
+        record.toFloor = slot.toFloor.load(std::memory_order_relaxed);
+        
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != expected) {
+            continue;
+        }
+        
+        out.push_back(record);
+    }
+    
+    return out.size();
+}
+
+size_t EventRing::getCapacity() const {
+    return capacity;
+}
+
+uint64_t EventRing::getTotalPushed() const {
+    return nextIndex.load(std::memory_order_relaxed);
+}
+
+std::string formatEventRecord(const EventRecord& record) {
+    std::time_t seconds = static_cast<std::time_t>(record.timestampMs / 1000);
+    std::tm localTime;
+    localtime_r(&seconds, &localTime);
+    
+    char buffer[128];
+    std::snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d.%03d %.*s elevator=%d from=%d to=%d",
+                  localTime.tm_hour, localTime.tm_min, localTime.tm_sec,
+                  static_cast<int>(record.timestampMs % 1000),
+                  static_cast<int>(toString(record.type).size()), toString(record.type).data(),
+                  record.elevatorId, record.fromFloor, record.toFloor);
+    return buffer;
+}
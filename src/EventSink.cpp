@@ -0,0 +1,133 @@
+#include "EventSink.h"
+#include "EnumStrings.h"
+#include "Trace.h"
+#include <algorithm>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+std::string EventSink::formatTimestamp(std::chrono::system_clock::time_point time) {
+    std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+    std::tm localTime;
+    localtime_r(&seconds, &localTime);
+    
+    std::stringstream ss;
+    ss << std::put_time(&localTime, "%Y-%m-%d %H:%M:%S");
+    return ss.str();
+}
+
+MemoryEventSink::MemoryEventSink(size_t capacity)
+    : capacity(capacity) {
+}
+
+void MemoryEventSink::logEvent(LogEventType eventType, int elevatorId, int fromFloor, int toFloor) {
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    
+    if (events.size() >= capacity) {
+        events.pop_front();
+    }
+    events.push_back({eventType, elevatorId, fromFloor, toFloor, std::chrono::system_clock::now()});
+}
+
+void MemoryEventSink::syncElevatorState(int elevatorId, int currentFloor, int destFloor, int direction, int status) {
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    states[elevatorId] = ElevatorState(elevatorId, currentFloor, destFloor,
+                                       static_cast<Direction>(direction), static_cast<ElevatorStatus>(status));
+}
+
+std::vector<EventSink::ElevatorState> MemoryEventSink::getElevatorStates() {
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    
+    std::vector<ElevatorState> result;
+    for (const auto& [id, state] : states) {
+        result.push_back(state);
+    }
+    return result;
+}
+
+std::vector<EventSink::LogRow> MemoryEventSink::getRecentLogs(int limit, std::chrono::system_clock::time_point before) {
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    
+    std::vector<LogRow> logs;
+    for (auto it = events.rbegin(); it != events.rend() && static_cast<int>(logs.size()) < limit; ++it) {
+        if (it->time >= before) {
+            continue;
+        }
+        logs.emplace_back(formatTimestamp(it->time), std::string(toString(it->eventType)),
+                          it->elevatorId, it->fromFloor, it->toFloor);
+    }
+    return logs;
+}
+
+std::vector<MemoryEventSink::Event> MemoryEventSink::getEvents() const {
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    return std::vector<Event>(events.begin(), events.end());
+}
+
+JournalEventSink::JournalEventSink(const std::string& path)
+    : path(path) {
+}
+
+void JournalEventSink::open() {
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    
+    if (!out.is_open()) {
+        out.open(path, std::ios::app);
+        if (!out) {
+            std::cerr << "Error opening event journal " << path << std::endl;
+        }
+    }
+}
+
+void JournalEventSink::close() {
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    out.close();
+}
+
+bool JournalEventSink::isConnected() const {
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    return out.is_open() && out.good();
+}
+
+void JournalEventSink::logEvent(LogEventType eventType, int elevatorId, int fromFloor, int toFloor) {
+    TRACE_SCOPE("JournalEventSink::logEvent");
+    
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    
+    if (!out.is_open()) {
+        return;
+    }
+    
+    auto writeStart = std::chrono::steady_clock::now();
+    out << formatTimestamp(std::chrono::system_clock::now()) << ' ' << toString(eventType) << ' '
+        << elevatorId << ' ' << fromFloor << ' ' << toFloor << std::endl;
+    writeLatency.record(std::chrono::steady_clock::now() - writeStart);
+}
+
+std::vector<EventSink::LogRow> JournalEventSink::getRecentLogs(int limit, std::chrono::system_clock::time_point before) {
+    std::lock_guard<ProfiledMutex> lock(mutex);
+    
+    // Keep the last `limit` lines; the journal is for debugging, not queries.
+    // Its times are whole seconds, so lines in `before`'s own second are left out.
+    std::string cutoff = before == std::chrono::system_clock::time_point::max() ? "" : formatTimestamp(before);
+    std::deque<LogRow> tail;
+    std::ifstream in(path);
+    std::string date, time, eventType;
+    int elevatorId, fromFloor, toFloor;
+    while (in >> date >> time >> eventType >> elevatorId >> fromFloor >> toFloor) {
+        if (!cutoff.empty() && date + " " + time >= cutoff) {
+            continue;
+        }
+        tail.emplace_back(date + " " + time, eventType, elevatorId, fromFloor, toFloor);
+        if (static_cast<int>(tail.size()) > limit) {
+            tail.pop_front();
+        }
+    }
+    
+    return std::vector<LogRow>(tail.rbegin(), tail.rend());
+}
+
+LatencyHistogram::Snapshot JournalEventSink::getWriteLatency() const {
+    return writeLatency.snapshot();
+}
@@ -0,0 +1,214 @@
+#include "ExperimentRunner.h"
+#include "EnumStrings.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+// Parse a whole string_view as a non-negative int
+static std::optional<int> parseInt(std::string_view text) {
+    int value = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec != std::errc() || result.ptr != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// Parse a whole string_view as a seed, over the same range as --seed
+static std::optional<uint64_t> parseSeed(std::string_view text) {
+    uint64_t value = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec != std::errc() || result.ptr != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+static std::optional<double> parseDouble(std::string_view text) {
+    std::string copy(text);
+    char* end = nullptr;
+    double value = std::strtod(copy.c_str(), &end);
+    if (copy.empty() || end != copy.c_str() + copy.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// Split "a,b,c" and parse each entry; std::nullopt if any entry is bad
+template <typename T, typename Parse>
+static std::optional<std::vector<T>> parseList(std::string_view list, Parse parse) {
+    std::vector<T> values;
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        auto value = parse(list.substr(0, comma));
+        if (!value) {
+            return std::nullopt;
+        }
+        values.push_back(*value);
+        list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+    }
+    if (values.empty()) {
+        return std::nullopt;
+    }
+    return values;
+}
+
+std::optional<ExperimentGrid> parseExperimentGrid(std::string_view spec) {
+    ExperimentGrid grid;
+    
+    while (!spec.empty()) {
+        size_t semicolon = spec.find(';');
+        std::string_view entry = spec.substr(0, semicolon);
+        spec = semicolon == std::string_view::npos ? std::string_view() : spec.substr(semicolon + 1);
+        
+        size_t equals = entry.find('=');
+        if (equals == std::string_view::npos) {
+            return std::nullopt;
+        }
+        std::string_view key = entry.substr(0, equals);
+        std::string_view value = entry.substr(equals + 1);
+        
+        if (key == "policy") {
+            auto policies = parseList<DispatchMode>(value, parseDispatchMode);
+            if (!policies) {
+                return std::nullopt;
+            }
+            grid.policies = *policies;
+        } else if (key == "traffic") {
+            auto traffic = parseList<TrafficProfile>(value, parseTrafficProfile);
+            if (!traffic) {
+                return std::nullopt;
+            }
+            grid.traffic = *traffic;
+        } else if (key == "cars" || key == "capacity") {
+            auto counts = parseList<int>(value, parseInt);
+            if (!counts || std::any_of(counts->begin(), counts->end(), [](int count) { return count < 1; })) {
+                return std::nullopt;
+            }
+            (key == "cars" ? grid.cars : grid.capacities) = *counts;
+        } else if (key == "floors" || key == "runs") {
+            auto number = parseInt(value);
+            if (!number || *number < (key == "floors" ? 2 : 1)) {
+                return std::nullopt;
+            }
+            (key == "floors" ? grid.floors : grid.runs) = *number;
+        } else if (key == "seed") {
+            auto seed = parseSeed(value);
+            if (!seed) {
+                return std::nullopt;
+            }
+            grid.firstSeed = *seed;
+        } else if (key == "rate" || key == "hours") {
+            auto number = parseDouble(value);
+            if (!number || *number <= 0.0) {
+                return std::nullopt;
+            }
+            if (key == "rate") {
+                grid.passengersPerHour = *number;
+            } else {
+                grid.duration = std::chrono::seconds(static_cast<int64_t>(*number * 3600.0));
+            }
+        } else {
+            return std::nullopt;
+        }
+    }
+    
+    return grid;
+}
+
+ExperimentRunner::ExperimentRunner(const ExperimentGrid& experimentGrid, unsigned jobCount)
+    : grid(experimentGrid), jobs(jobCount) {
+    if (jobs == 0) {
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+size_t ExperimentRunner::getRunCount() const {
+    return grid.policies.size() * grid.cars.size() * grid.capacities.size() *
+           grid.traffic.size() * static_cast<size_t>(grid.runs);
+}
+
+std::vector<SimulationConfig> ExperimentRunner::expandGrid() const {
+    // Seeds vary fastest, so the runs of one cell are adjacent
+    std::vector<SimulationConfig> configs;
+    configs.reserve(getRunCount());
+    
+    for (DispatchMode policy : grid.policies) {
+        for (int cars : grid.cars) {
+            for (int capacity : grid.capacities) {
+                for (TrafficProfile traffic : grid.traffic) {
+                    for (int run = 0; run < grid.runs; run++) {
+                        SimulationConfig config;
+                        config.policy = policy;
+                        config.cars = cars;
+                        config.floors = grid.floors;
+                        config.capacity = capacity;
+                        config.traffic = traffic;
+                        config.passengersPerHour = grid.passengersPerHour;
+                        config.duration = grid.duration;
+                        config.seed = grid.firstSeed.value_or(ExperimentGrid::DEFAULT_FIRST_SEED) + static_cast<uint64_t>(run);
+                        config.kinematics = grid.kinematics;
+                        configs.push_back(config);
+                    }
+                }
+            }
+        }
+    }
+    
+    return configs;
+}
+
+std::vector<ExperimentRow> ExperimentRunner::run() {
+    std::vector<SimulationConfig> configs = expandGrid();
+    std::vector<SimulationResult> results(configs.size());
+    std::atomic<size_t> nextRun{0};
+    
+    auto worker = [&] {
+        for (size_t i = nextRun.fetch_add(1, std::memory_order_relaxed); i < configs.size();
+             i = nextRun.fetch_add(1, std::memory_order_relaxed)) {
+            results[i] = Simulation(configs[i]).run();
+        }
+    };
+    
+    std::vector<std::thread> workers;
+    unsigned threadCount = static_cast<unsigned>(std::min<size_t>(jobs, configs.size()));
+    for (unsigned i = 0; i < threadCount; i++) {
+        workers.emplace_back(worker);
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    
+    std::vector<ExperimentRow> rows;
+    for (size_t i = 0; i < configs.size(); i += grid.runs) {
+        const SimulationConfig& config = configs[i];
+        ExperimentRow row{config.policy, config.cars, config.capacity, config.traffic, grid.runs, SimulationResult()};
+        for (int run = 0; run < grid.runs; run++) {
+            row.total.merge(results[i + run]);
+        }
+        rows.push_back(std::move(row));
+    }
+    
+    return rows;
+}
+
+void ExperimentRunner::writeCsv(std::ostream& out, const std::vector<ExperimentRow>& rows) {
+    out << "policy,cars,capacity,traffic,runs,passengers,avg_wait_s,p95_wait_s,avg_journey_s,"
+           "trips,floors_travelled,energy_kwh,event_digest\n";
+    
+    char line[256];
+    for (const auto& row : rows) {
+        double runs = row.runs;
+        std::snprintf(line, sizeof(line), "%s,%d,%d,%s,%d,%.1f,%.2f,%.2f,%.2f,%.1f,%.1f,%.3f,%016llx\n",
+                      toString(row.policy).data(), row.cars, row.capacity, toString(row.traffic).data(),
+                      row.runs, row.total.passengers / runs, row.total.averageWaitSeconds(),
+                      row.total.waitQuantileSeconds(0.95), row.total.averageJourneySeconds(),
+                      row.total.trips / runs, row.total.floorsTravelled / runs, row.total.energyKwh / runs,
+                      static_cast<unsigned long long>(row.total.eventDigest));
+        out << line;
+    }
+}
@@ -0,0 +1,68 @@
+#include "Kinematics.h"
+#include <algorithm>
+#include <cmath>
+
+std::chrono::milliseconds DoorTiming::stopTime(int passengersExchanged) const {
+    int dwell = std::max(minDwellMs, perPassengerMs * passengersExchanged);
+    return std::chrono::milliseconds(openMs + dwell + closeMs);
+}
+
+double travelTimeSeconds(const MotionProfile& profile, double distance) {
+    if (distance <= 0.0) {
+        return 0.0;
+    }
+    
+    double v = profile.maxSpeed;
+    double a = profile.acceleration;
+    double j = profile.jerk;
+    
+    // If full speed comes before full acceleration, the profile never
+    // reaches a and peaks at sqrt(v * j) instead
+    if (v * j < a * a) {
+        a = std::sqrt(v * j);
+    }
+    
+    // Time to get from rest to v (and, by symmetry, back to rest)
+    double rampTime = v / a + a / j;
+    
+    // Long trips cruise at v between the two ramps
+    if (distance >= v * rampTime) {
+        return distance / v + rampTime;
+    }
+    
+    // Short trips peak below v. If the peak still reaches full acceleration,
+    // solve distance = vp * (vp / a + a / j) for the peak speed vp.
+    double peak = 0.5 * a * (-a / j + std::sqrt(a * a / (j * j) + 4.0 * distance / a));
+    if (peak >= a * a / j) {
+        return 2.0 * (peak / a + a / j);
+    }
+    
+    // Very short trips are pure jerk: four segments of t1 with distance = 2 j t1^3
+    double t1 = std::cbrt(distance / (2.0 * j));
+    return 4.0 * t1;
+}
+
+TravelTimeTable::TravelTimeTable(int floors, const MotionProfile& profile,
+                                 const std::vector<double>& storeyHeights)
+    : numFloors(floors), positions(floors + 1, 0.0),
+      travelMs(static_cast<size_t>(floors + 1) * (floors + 1), 0) {
+    
+    double height = DEFAULT_FLOOR_HEIGHT;
+    for (int floor = 2; floor <= numFloors; floor++) {
+        size_t storey = static_cast<size_t>(floor - 2);
+        if (storey < storeyHeights.size()) {
+            height = storeyHeights[storey];
+        }
+        positions[floor] = positions[floor - 1] + height;
+    }
+    
+    // Travel time only depends on distance, so fill both directions at once
+    for (int from = 1; from <= numFloors; from++) {
+        for (int to = from + 1; to <= numFloors; to++) {
+            double seconds = travelTimeSeconds(profile, positions[to] - positions[from]);
+            auto ms = static_cast<uint32_t>(std::lround(seconds * 1000.0));
+            travelMs[static_cast<size_t>(from) * (numFloors + 1) + to] = ms;
+            travelMs[static_cast<size_t>(to) * (numFloors + 1) + from] = ms;
+        }
+    }
+}
@@ -0,0 +1,84 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <utility>
+
+static std::atomic<uint64_t> nextHistogramId{0};
+
+LatencyHistogram::LatencyHistogram()
+    : histogramId(nextHistogramId.fetch_add(1)) {
+}
+
+LatencyHistogram::Shard& LatencyHistogram::localShard() {
+    struct CacheEntry {
+        uint64_t id = ~0ull;
+        Shard* shard = nullptr;
+    };
+    thread_local std::array<CacheEntry, THREAD_CACHE_SLOTS> threadShards;
+    
+    CacheEntry& entry = threadShards[histogramId % THREAD_CACHE_SLOTS];
+    if (entry.id == histogramId) {
+        return *entry.shard;
+    }
+    
+    // Evicted by another histogram, or the first record from this thread:
+    // reuse this thread's shard if it has one, so shards stay one per thread
+    auto self = std::this_thread::get_id();
+    std::lock_guard<std::mutex> lock(shardsMutex);
+    auto owned = std::find_if(shards.begin(), shards.end(), [self](const auto& shard) {
+        return shard->owner == self;
+    });
+    if (owned == shards.end()) {
+        shards.push_back(std::make_unique<Shard>());
+        shards.back()->owner = self;
+        owned = shards.end() - 1;
+    }
+    
+    entry.id = histogramId;
+    entry.shard = owned->get();
+    return *entry.shard;
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds elapsed) {
+    uint64_t nanos = elapsed.count() > 0 ? static_cast<uint64_t>(elapsed.count()) : 0;
+    uint64_t micros = nanos / 1000;
+    
+    size_t bucket = std::lower_bound(BUCKET_BOUNDS_US.begin(), BUCKET_BOUNDS_US.end(), micros)
+                    - BUCKET_BOUNDS_US.begin();
+    
+    Shard& shard = localShard();
+    shard.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+    shard.sumNanos.fetch_add(nanos, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot result;
+    
+    std::lock_guard<std::mutex> lock(shardsMutex);
+    for (const auto& shard : shards) {
+        for (size_t i = 0; i < NUM_BUCKETS; i++) {
+            result.buckets[i] += shard->buckets[i].load(std::memory_order_relaxed);
+        }
+        result.count += shard->count.load(std::memory_order_relaxed);
+        result.sumNanos += shard->sumNanos.load(std::memory_order_relaxed);
+    }
+    
+    return result;
+}
+
+uint64_t approximateQuantileUs(const LatencyHistogram::Snapshot& snapshot, double q) {
+    if (snapshot.count == 0) {
+        return 0;
+    }
+    
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(snapshot.count));
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < LatencyHistogram::BUCKET_BOUNDS_US.size(); i++) {
+        cumulative += snapshot.buckets[i];
+        if (cumulative > rank) {
+            return LatencyHistogram::BUCKET_BOUNDS_US[i];
+        }
+    }
+    
+    return LatencyHistogram::BUCKET_BOUNDS_US.back();
+}
@@ -0,0 +1,140 @@
+#include "DatabaseConnection.h"
+#include "EnumStrings.h"
+#include <pqxx/pqxx>
+
+// libpqxx implementation of DatabaseConnection
+class PostgresConnection : public DatabaseConnection {
+public:
+    explicit PostgresConnection(const std::string& options) : conn(options) {}
+    
+    bool isOpen() const override {
+        return conn.is_open();
+    }
+    
+    std::string describe() const override {
+        return std::string(conn.dbname()) + " as " + conn.username();
+    }
+    
+    void createSchema() override {
+        run([&](pqxx::work& txn) {
+            txn.exec(
+                "CREATE TABLE IF NOT EXISTS elevators ("
+                "   id INTEGER PRIMARY KEY,"
+                "   current_floor INTEGER NOT NULL,"
+                "   destination_floor INTEGER NOT NULL,"
+                "   direction INTEGER NOT NULL,"
+                "   status INTEGER NOT NULL,"
+                "   updated_at TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP"
+                ");"
+            );
+            
+            txn.exec(
+                "CREATE TABLE IF NOT EXISTS elevator_logs ("
+                "   id SERIAL PRIMARY KEY,"
+                "   timestamp TIMESTAMP WITH TIME ZONE DEFAULT CURRENT_TIMESTAMP,"
+                "   event_type VARCHAR(50) NOT NULL,"
+                "   elevator_id INTEGER,"
+                "   from_floor INTEGER,"
+                "   to_floor INTEGER"
+                ");"
+            );
+        });
+    }
+    
+    void insertLog(LogEventType eventType, int elevatorId, int fromFloor, int toFloor) override {
+        run([&](pqxx::work& txn) {
+            txn.exec_params(
+                "INSERT INTO elevator_logs (event_type, elevator_id, from_floor, to_floor) "
+                "VALUES ($1, $2, $3, $4)",
+                toString(eventType).data(), elevatorId, fromFloor, toFloor
+            );
+        });
+    }
+    
+    void insertLogs(const std::deque<LogEntry>& entries) override {
+        run([&](pqxx::work& txn) {
+            for (const auto& entry : entries) {
+                double epochSeconds = std::chrono::duration<double>(entry.time.time_since_epoch()).count();
+                txn.exec_params(
+                    "INSERT INTO elevator_logs (timestamp, event_type, elevator_id, from_floor, to_floor) "
+                    "VALUES (to_timestamp($1), $2, $3, $4, $5)",
+                    epochSeconds, toString(entry.eventType).data(), entry.elevatorId, entry.fromFloor, entry.toFloor
+                );
+            }
+        });
+    }
+    
+    void upsertElevator(int elevatorId, int currentFloor, int destFloor, int direction, int status) override {
+        run([&](pqxx::work& txn) {
+            txn.exec_params(
+                "INSERT INTO elevators (id, current_floor, destination_floor, direction, status, updated_at) "
+                "VALUES ($1, $2, $3, $4, $5, CURRENT_TIMESTAMP) "
+                "ON CONFLICT (id) DO UPDATE SET "
+                "current_floor = $2, destination_floor = $3, direction = $4, status = $5, "
+                "updated_at = CURRENT_TIMESTAMP",
+                elevatorId, currentFloor, destFloor, direction, status
+            );
+        });
+    }
+    
+    std::vector<EventSink::ElevatorState> selectElevators() override {
+        std::vector<EventSink::ElevatorState> states;
+        run([&](pqxx::work& txn) {
+            pqxx::result result = txn.exec(
+                "SELECT id, current_floor, destination_floor, direction, status FROM elevators "
+                "ORDER BY id"
+            );
+            for (const auto& row : result) {
+                states.emplace_back(row[0].as<int>(), row[1].as<int>(), row[2].as<int>(),
+                                    static_cast<Direction>(row[3].as<int>()),
+                                    static_cast<ElevatorStatus>(row[4].as<int>()));
+            }
+        });
+        return states;
+    }
+    
+    std::vector<EventSink::LogRow> selectRecentLogs(int limit, std::chrono::system_clock::time_point before) override {
+        std::vector<EventSink::LogRow> logs;
+        run([&](pqxx::work& txn) {
+            pqxx::result result;
+            if (before == std::chrono::system_clock::time_point::max()) {
+                result = txn.exec_params(
+                    "SELECT timestamp, event_type, elevator_id, from_floor, to_floor FROM elevator_logs "
+                    "ORDER BY timestamp DESC LIMIT $1",
+                    limit
+                );
+            } else {
+                double epochSeconds = std::chrono::duration<double>(before.time_since_epoch()).count();
+                result = txn.exec_params(
+                    "SELECT timestamp, event_type, elevator_id, from_floor, to_floor FROM elevator_logs "
+                    "WHERE timestamp < to_timestamp($2) ORDER BY timestamp DESC LIMIT $1",
+                    limit, epochSeconds
+                );
+            }
+            for (const auto& row : result) {
+                logs.emplace_back(row[0].as<std::string>(), row[1].as<std::string>(), row[2].as<int>(),
+                                  row[3].as<int>(), row[4].as<int>());
+            }
+        });
+        return logs;
+    }
+
+private:
+    pqxx::connection conn;
+    
+    // Run body in one committed transaction, reporting a lost server as Broken
+    template <typename Body>
+    void run(Body body) {
+        try {
+            pqxx::work txn(conn);
+            body(txn);
+            txn.commit();
+        } catch (const pqxx::broken_connection& e) {
+            throw Broken(e.what());
+        }
+    }
+};
+
+std::unique_ptr<DatabaseConnection> openDatabaseConnection(const std::string& options) {
+    return std::make_unique<PostgresConnection>(options);
+}
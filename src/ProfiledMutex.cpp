@@ -0,0 +1,95 @@
+#include "ProfiledMutex.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstdio>
+
+LockProfiler& LockProfiler::instance() {
+    static LockProfiler profiler;
+    return profiler;
+}
+
+LockProfile& LockProfiler::profile(const std::string& name) {
+    std::lock_guard<std::mutex> lock(profilesMutex);
+    
+    auto& entry = profiles[name];
+    if (!entry) {
+        entry = std::make_unique<LockProfile>(name);
+    }
+    return *entry;
+}
+
+std::vector<LockProfiler::LockReport> LockProfiler::report() const {
+    std::vector<LockReport> reports;
+    
+    std::lock_guard<std::mutex> lock(profilesMutex);
+    for (const auto& [name, profile] : profiles) {
+        LockReport entry;
+        entry.name = name;
+        entry.wait = profile->waitTime.snapshot();
+        entry.hold = profile->holdTime.snapshot();
+        entry.acquisitions = entry.wait.count;
+        entry.contended = profile->contended.load(std::memory_order_relaxed);
+        reports.push_back(std::move(entry));
+    }
+    
+    return reports;
+}
+
+std::string LockProfiler::formatReport() const {
+    auto reports = report();
+    std::sort(reports.begin(), reports.end(), [](const LockReport& a, const LockReport& b) {
+        return a.wait.sumNanos > b.wait.sumNanos;
+    });
+    
+    std::string out = "Lock profile (wait/hold percentiles are bucket upper bounds):\n";
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-36s %10s %9s %11s %11s %11s %11s\n",
+                  "Lock", "Acquired", "Contended", "Wait total", "Wait p99", "Hold total", "Hold p99");
+    out += line;
+    
+    for (const auto& entry : reports) {
+        std::snprintf(line, sizeof(line), "%-36s %10llu %9llu %9.3fms %9lluus %9.3fms %9lluus\n",
+                      entry.name.c_str(),
+                      static_cast<unsigned long long>(entry.acquisitions),
+                      static_cast<unsigned long long>(entry.contended),
+                      static_cast<double>(entry.wait.sumNanos) / 1e6,
+                      static_cast<unsigned long long>(approximateQuantileUs(entry.wait, 0.99)),
+                      static_cast<double>(entry.hold.sumNanos) / 1e6,
+                      static_cast<unsigned long long>(approximateQuantileUs(entry.hold, 0.99)));
+        out += line;
+    }
+    
+    return out;
+}
+
+ProfiledMutex::ProfiledMutex(const std::string& name)
+    : profile(LockProfiler::instance().profile(name)) {
+}
+
+void ProfiledMutex::lock() {
+    auto start = std::chrono::steady_clock::now();
+    
+    if (!mutex.try_lock()) {
+        TRACE_SCOPE(profile.waitSpanName.c_str());
+        mutex.lock();
+        profile.contended.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    acquiredAt = std::chrono::steady_clock::now();
+    profile.waitTime.record(acquiredAt - start);
+}
+
+bool ProfiledMutex::try_lock() {
+    if (!mutex.try_lock()) {
+        return false;
+    }
+    
+    acquiredAt = std::chrono::steady_clock::now();
+    profile.waitTime.record(std::chrono::nanoseconds(0));
+    return true;
+}
+
+void ProfiledMutex::unlock() {
+    profile.holdTime.record(std::chrono::steady_clock::now() - acquiredAt);
+    mutex.unlock();
+}
@@ -0,0 +1,240 @@
+#include "ShardedController.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+// Parse a whole string_view as a non-negative int
+static std::optional<int> parseInt(std::string_view text) {
+    int value = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec != std::errc() || result.ptr != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// Names go unescaped into the status JSON and the metrics labels
+static bool isShardNameChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-';
+}
+
+std::optional<std::vector<ShardConfig>> parseShardSpec(std::string_view spec) {
+    std::vector<ShardConfig> configs;
+    
+    while (!spec.empty()) {
+        size_t comma = spec.find(',');
+        std::string_view entry = spec.substr(0, comma);
+        spec = comma == std::string_view::npos ? std::string_view() : spec.substr(comma + 1);
+        
+        size_t firstColon = entry.find(':');
+        size_t secondColon = firstColon == std::string_view::npos ? firstColon : entry.find(':', firstColon + 1);
+        if (firstColon == 0 || secondColon == std::string_view::npos) {
+            return std::nullopt;
+        }
+        
+        auto elevators = parseInt(entry.substr(firstColon + 1, secondColon - firstColon - 1));
+        auto floors = parseInt(entry.substr(secondColon + 1));
+        if (!elevators || !floors || *elevators < 1 || *floors < 2) {
+            return std::nullopt;
+        }
+        
+        std::string name(entry.substr(0, firstColon));
+        if (!std::all_of(name.begin(), name.end(), isShardNameChar)) {
+            return std::nullopt;
+        }
+        for (const auto& existing : configs) {
+            if (existing.name == name) {
+                return std::nullopt;
+            }
+        }
+        
+        configs.push_back(ShardConfig{std::move(name), *elevators, *floors});
+    }
+    
+    if (configs.empty()) {
+        return std::nullopt;
+    }
+    
+    return configs;
+}
+
+// CPUs this process is allowed to run on, in ascending order
+static std::vector<int> getAllowedCpus() {
+    std::vector<int> cpus;
+    
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    
+    return cpus;
+}
+
+ShardedController::ShardedController(const std::vector<ShardConfig>& shardConfigs, bool pinDispatchers,
+                                     const EventSinkFactory& makeEventSink)
+    : configs(shardConfigs) {
+    
+    std::vector<int> cpus = pinDispatchers ? getAllowedCpus() : std::vector<int>();
+    
+    int firstElevatorId = 0;
+    for (size_t i = 0; i < configs.size(); i++) {
+        auto shard = std::make_unique<ElevatorController>(configs[i].elevators, configs[i].floors, firstElevatorId,
+                                                          makeEventSink ? makeEventSink(i) : nullptr);
+        firstElevatorId += configs[i].elevators;
+        
+        // Shards share the elevators table; a shard must not adopt its
+        // neighbours' rows as extra cars
+        if (configs.size() > 1) {
+            shard->setAdoptDatabaseElevators(false);
+        }
+        
+        if (!cpus.empty()) {
+            shard->setDispatcherCpu(cpus[i % cpus.size()]);
+        }
+        
+        shards.push_back(std::move(shard));
+    }
+}
+
+ShardedController::~ShardedController() {
+    stop();
+}
+
+void ShardedController::start() {
+    for (auto& shard : shards) {
+        shard->start();
+    }
+}
+
+void ShardedController::stop() {
+    for (auto& shard : shards) {
+        shard->stop();
+    }
+}
+
+std::optional<size_t> ShardedController::findShard(std::string_view idOrName) const {
+    for (size_t i = 0; i < configs.size(); i++) {
+        if (configs[i].name == idOrName) {
+            return i;
+        }
+    }
+    
+    auto id = parseInt(idOrName);
+    if (id && *id >= 0 && static_cast<size_t>(*id) < shards.size()) {
+        return static_cast<size_t>(*id);
+    }
+    
+    return std::nullopt;
+}
+
+bool ShardedController::applyServedFloorsSpec(std::string_view spec) {
+    size_t equals = spec.find('=');
+    if (equals == std::string_view::npos || getTotalElevators() == 0) {
+        return false;
+    }
+    
+    auto cars = parseBitList(spec.substr(0, equals), 0, static_cast<size_t>(getTotalElevators() - 1));
+    if (!cars) {
+        return false;
+    }
+    
+    bool applied = true;
+    forEachCommonBit(*cars, *cars, [&](size_t car) {
+        int elevatorId = static_cast<int>(car);
+        for (auto& shard : shards) {
+            if (!shard->hasElevator(elevatorId)) {
+                continue;
+            }
+            auto floors = parseBitList(spec.substr(equals + 1), 1, static_cast<size_t>(shard->getNumFloors()));
+            applied = applied && floors && shard->setServedFloors(elevatorId, *floors);
+        }
+    });
+    
+    return applied;
+}
+
+bool ShardedController::setCapacity(int passengers) {
+    bool applied = true;
+    for (auto& shard : shards) {
+        applied = shard->setCapacity(-1, passengers) && applied;
+    }
+    return applied;
+}
+
+bool ShardedController::setKinematics(const KinematicConfig& config) {
+    bool applied = true;
+    for (auto& shard : shards) {
+        applied = shard->setKinematics(config) && applied;
+    }
+    return applied;
+}
+
+std::string getShardPath(const std::string& path, const std::vector<ShardConfig>& configs, size_t shardId) {
+    return configs.size() == 1 ? path : path + "." + configs[shardId].name;
+}
+
+std::string ShardedController::getShardPath(const std::string& path, size_t shardId) const {
+    return ::getShardPath(path, configs, shardId);
+}
+
+void ShardedController::setCheckpointFile(const std::string& path, std::chrono::milliseconds interval) {
+    for (size_t i = 0; i < shards.size(); i++) {
+        shards[i]->setCheckpointFile(getShardPath(path, i), interval);
+    }
+}
+
+size_t ShardedController::restoreCheckpoint(const std::string& path) {
+    size_t restored = 0;
+    for (size_t i = 0; i < shards.size(); i++) {
+        auto snapshot = readSnapshotFile(getShardPath(path, i));
+        if (snapshot && shards[i]->restore(*snapshot)) {
+            restored++;
+        }
+    }
+    return restored;
+}
+
+void ShardedController::setDispatchMode(DispatchMode mode) {
+    for (auto& shard : shards) {
+        shard->setDispatchMode(mode);
+    }
+}
+
+void ShardedController::setCallReassignment(bool enabled) {
+    for (auto& shard : shards) {
+        shard->setCallReassignment(enabled);
+    }
+}
+
+void ShardedController::setParkingPolicy(bool enabled) {
+    for (auto& shard : shards) {
+        shard->setParkingPolicy(enabled);
+    }
+}
+
+int ShardedController::getTotalElevators() const {
+    int total = 0;
+    for (const auto& shard : shards) {
+        total += shard->getNumElevators();
+    }
+    return total;
+}
+
+size_t ShardedController::getTotalPendingRequests() const {
+    size_t total = 0;
+    for (const auto& shard : shards) {
+        total += shard->getPendingRequestCount();
+    }
+    return total;
+}
@@ -0,0 +1,53 @@
+#include "SimRandom.h"
+#include <cmath>
+#include <limits>
+
+static uint64_t rotl(uint64_t value, int shift) {
+    return (value << shift) | (value >> (64 - shift));
+}
+
+SimRandom::SimRandom(uint64_t seed) {
+    // splitmix64 spreads any seed, including 0, over the whole state
+    for (uint64_t& word : state) {
+        seed += 0x9e3779b97f4a7c15ULL;
+        uint64_t mixed = seed;
+        mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebULL;
+        word = mixed ^ (mixed >> 31);
+    }
+}
+
+uint64_t SimRandom::next() {
+    uint64_t result = rotl(state[1] * 5, 7) * 9;
+    uint64_t shifted = state[1] << 17;
+    
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= shifted;
+    state[3] = rotl(state[3], 45);
+    
+    return result;
+}
+
+double SimRandom::uniform() {
+    return (next() >> 11) * 0x1.0p-53;
+}
+
+int SimRandom::uniformInt(int low, int high) {
+    uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(high) - low) + 1;
+    
+    // Reject draws from the incomplete block at the top of the 64-bit range
+    uint64_t limit = std::numeric_limits<uint64_t>::max() - std::numeric_limits<uint64_t>::max() % range;
+    uint64_t draw;
+    do {
+        draw = next();
+    } while (draw >= limit);
+    
+    return static_cast<int>(low + static_cast<int64_t>(draw % range));
+}
+
+double SimRandom::exponential(double rate) {
+    return -std::log1p(-uniform()) / rate;
+}
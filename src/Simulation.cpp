@@ -0,0 +1,350 @@
+#include "Simulation.h"
+#include "ElevatorController.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static constexpr int64_t NEVER = std::numeric_limits<int64_t>::max();
+
+void SimulationResult::recordWait(int64_t waitMs) {
+    size_t bucket = std::min(static_cast<size_t>(waitMs / WAIT_BUCKET_MS), WAIT_BUCKETS - 1);
+    waitHistogram[bucket]++;
+    totalWaitSeconds += waitMs / 1000.0;
+}
+
+// FNV-1a over the bytes of value
+static void mixDigest(uint64_t& digest, uint64_t value) {
+    for (int byte = 0; byte < 8; byte++) {
+        digest ^= (value >> (byte * 8)) & 0xff;
+        digest *= 0x100000001b3ULL;
+    }
+}
+
+void SimulationResult::recordEvent(int64_t timeMs, int subject, int detail) {
+    mixDigest(eventDigest, static_cast<uint64_t>(timeMs));
+    mixDigest(eventDigest, static_cast<uint64_t>(subject));
+    mixDigest(eventDigest, static_cast<uint64_t>(detail));
+}
+
+void SimulationResult::merge(const SimulationResult& other) {
+    passengers += other.passengers;
+    trips += other.trips;
+    floorsTravelled += other.floorsTravelled;
+    totalWaitSeconds += other.totalWaitSeconds;
+    totalJourneySeconds += other.totalJourneySeconds;
+    energyKwh += other.energyKwh;
+    mixDigest(eventDigest, other.eventDigest);
+    for (size_t i = 0; i < WAIT_BUCKETS; i++) {
+        waitHistogram[i] += other.waitHistogram[i];
+    }
+}
+
+double SimulationResult::averageWaitSeconds() const {
+    return passengers > 0 ? totalWaitSeconds / passengers : 0.0;
+}
+
+double SimulationResult::averageJourneySeconds() const {
+    return passengers > 0 ? totalJourneySeconds / passengers : 0.0;
+}
+
+double SimulationResult::waitQuantileSeconds(double q) const {
+    uint64_t total = 0;
+    for (uint32_t count : waitHistogram) {
+        total += count;
+    }
+    if (total == 0) {
+        return 0.0;
+    }
+    
+    auto target = static_cast<uint64_t>(std::ceil(q * total));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < WAIT_BUCKETS; i++) {
+        seen += waitHistogram[i];
+        if (seen >= target && seen > 0) {
+            return (i + 1) * WAIT_BUCKET_MS / 1000.0;
+        }
+    }
+    return WAIT_BUCKETS * WAIT_BUCKET_MS / 1000.0;
+}
+
+Simulation::Simulation(const SimulationConfig& simConfig)
+    : config(simConfig),
+      table(simConfig.floors, simConfig.kinematics.motion, simConfig.kinematics.storeyHeights),
+      boardingHoldMs(simConfig.policy == DispatchMode::DESTINATION
+                         ? ElevatorController::DESTINATION_BOARDING_HOLD.count() : 0),
+      rng(simConfig.seed),
+      cars(static_cast<size_t>(simConfig.cars)),
+      now(0) {
+}
+
+SimulationResult Simulation::run() {
+    const int64_t endMs = std::chrono::duration_cast<std::chrono::milliseconds>(config.duration).count();
+    const double arrivalsPerMs = config.passengersPerHour / 3600000.0;
+    
+    auto nextArrivalAfter = [&](int64_t time) {
+        if (config.passengersPerHour <= 0.0) {
+            return NEVER;
+        }
+        int64_t next = time + std::llround(rng.exponential(arrivalsPerMs));
+        return next < endMs ? next : NEVER;
+    };
+    int64_t nextArrival = nextArrivalAfter(0);
+    
+    while (true) {
+        // Idle cars with queued work set off at once
+        for (auto& car : cars) {
+            if (car.phase == Phase::IDLE && !car.queue.empty()) {
+                startTrip(car);
+            }
+        }
+        
+        Car* nextCar = nullptr;
+        for (auto& car : cars) {
+            if (car.phase != Phase::IDLE && (!nextCar || car.eventAt < nextCar->eventAt)) {
+                nextCar = &car;
+            }
+        }
+        
+        if (nextArrival == NEVER && !nextCar) {
+            break;
+        }
+        
+        // Ties go to the arrival so it can still join a boarding car
+        if (!nextCar || nextArrival <= nextCar->eventAt) {
+            now = nextArrival;
+            Group group = sampleArrival();
+            result.recordEvent(now, -group.fromFloor, group.toFloor);
+            dispatch(std::move(group));
+            nextArrival = nextArrivalAfter(now);
+        } else {
+            now = nextCar->eventAt;
+            result.recordEvent(now, static_cast<int>(nextCar - cars.data()), static_cast<int>(nextCar->phase));
+            if (nextCar->phase == Phase::BOARDING) {
+                board(*nextCar);
+            } else {
+                finishTrip(*nextCar);
+            }
+            retryPending();
+        }
+    }
+    
+    return result;
+}
+
+int64_t Simulation::travelMs(int fromFloor, int toFloor) const {
+    return table.travelTime(fromFloor, toFloor).count();
+}
+
+int64_t Simulation::stopMs(int passengers) const {
+    return config.kinematics.doors.stopTime(passengers).count();
+}
+
+int64_t Simulation::plannedTripTime(int startFloor, const Group& group) const {
+    // Same plan as Elevator::plannedTripTime
+    int64_t time = 0;
+    if (startFloor != group.fromFloor) {
+        time += travelMs(startFloor, group.fromFloor) + stopMs(group.size());
+    }
+    return time + boardingHoldMs + travelMs(group.fromFloor, group.toFloor) + stopMs(group.size());
+}
+
+int64_t Simulation::estimateTravelTime(const Car& car, int floor) const {
+    if (car.phase == Phase::IDLE && car.queue.empty()) {
+        return travelMs(car.floor, floor);
+    }
+    return std::max<int64_t>(car.activeDue - now, 0) + car.queuedWork + travelMs(car.committedEndFloor, floor);
+}
+
+void Simulation::recordRun(int fromFloor, int toFloor, int load) {
+    if (fromFloor == toFloor) {
+        return;
+    }
+    
+    result.trips++;
+    result.floorsTravelled += std::abs(toFloor - fromFloor);
+    
+    double distance = std::abs(table.floorPosition(toFloor) - table.floorPosition(fromFloor));
+    double imbalanceKg = (load - config.capacity / 2.0) * PASSENGER_MASS_KG;
+    if (toFloor < fromFloor) {
+        imbalanceKg = -imbalanceKg;
+    }
+    double liftJ = std::max(imbalanceKg, 0.0) * 9.81 * distance / DRIVE_EFFICIENCY;
+    double joules = distance * RUNNING_LOSS_J_PER_M + liftJ + DOOR_CYCLE_J;
+    result.energyKwh += joules / 3.6e6;
+}
+
+Simulation::Group Simulation::sampleArrival() {
+    Group group{1, 1, {now}};
+    auto interfloor = [&] {
+        group.fromFloor = rng.uniformInt(1, config.floors);
+        do {
+            group.toFloor = rng.uniformInt(1, config.floors);
+        } while (group.toFloor == group.fromFloor);
+    };
+    auto fromLobby = [&] { group.toFloor = rng.uniformInt(2, config.floors); };
+    auto toLobby = [&] { group.fromFloor = rng.uniformInt(2, config.floors); };
+    
+    double u = rng.uniform();
+    switch (config.traffic) {
+        case TrafficProfile::UP_PEAK:
+            if (u < 0.85) {
+                fromLobby();
+            } else if (u < 0.95) {
+                interfloor();
+            } else {
+                toLobby();
+            }
+            break;
+        case TrafficProfile::DOWN_PEAK:
+            if (u < 0.85) {
+                toLobby();
+            } else if (u < 0.95) {
+                interfloor();
+            } else {
+                fromLobby();
+            }
+            break;
+        case TrafficProfile::LUNCH:
+            if (u < 0.45) {
+                fromLobby();
+            } else if (u < 0.9) {
+                toLobby();
+            } else {
+                interfloor();
+            }
+            break;
+        case TrafficProfile::INTERFLOOR:
+            interfloor();
+            break;
+    }
+    
+    return group;
+}
+
+void Simulation::dispatch(Group group) {
+    if (config.policy == DispatchMode::DESTINATION && joinTrip(group)) {
+        return;
+    }
+    
+    // Same scoring and full-car bypass as ElevatorController::findBestElevator
+    Car* best = nullptr;
+    int64_t shortestTime = NEVER;
+    int needed = std::min(std::max(group.size(), 1), config.capacity);
+    for (auto& car : cars) {
+        int available = config.capacity - static_cast<int>(car.riders.size()) - car.queuedPassengers;
+        if (available < needed) {
+            continue;
+        }
+        
+        int64_t time = estimateTravelTime(car, group.fromFloor);
+        if (time < shortestTime) {
+            shortestTime = time;
+            best = &car;
+        }
+    }
+    
+    if (best) {
+        enqueue(*best, std::move(group));
+    } else {
+        pending.push_back(std::move(group));
+    }
+}
+
+bool Simulation::joinTrip(const Group& group) {
+    auto sameTrip = [&](const Group& trip) {
+        return trip.fromFloor == group.fromFloor && trip.toFloor == group.toFloor &&
+               trip.size() + group.size() <= config.capacity;
+    };
+    auto append = [&](Group& trip) {
+        trip.arrivals.insert(trip.arrivals.end(), group.arrivals.begin(), group.arrivals.end());
+    };
+    
+    for (auto& car : cars) {
+        if (car.phase == Phase::BOARDING && sameTrip(car.active)) {
+            car.activeDue += stopMs(car.active.size() + group.size()) - stopMs(car.active.size());
+            append(car.active);
+            car.queuedPassengers += group.size();
+            return true;
+        }
+        
+        auto trip = std::find_if(car.queue.begin(), car.queue.end(), [&](const QueuedTrip& queued) {
+            return sameTrip(queued.group);
+        });
+        if (trip != car.queue.end()) {
+            int64_t extraDwell = 2 * (stopMs(trip->group.size() + group.size()) - stopMs(trip->group.size()));
+            trip->plannedMs += extraDwell;
+            car.queuedWork += extraDwell;
+            append(trip->group);
+            car.queuedPassengers += group.size();
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+void Simulation::enqueue(Car& car, Group group) {
+    int startFloor = (car.phase != Phase::IDLE || !car.queue.empty()) ? car.committedEndFloor : car.floor;
+    int64_t plannedMs = plannedTripTime(startFloor, group);
+    
+    car.queuedPassengers += group.size();
+    car.queuedWork += plannedMs;
+    car.committedEndFloor = group.toFloor;
+    car.queue.push_back(QueuedTrip{std::move(group), plannedMs});
+}
+
+void Simulation::retryPending() {
+    for (size_t count = pending.size(); count > 0; count--) {
+        Group group = std::move(pending.front());
+        pending.pop_front();
+        dispatch(std::move(group));
+    }
+}
+
+void Simulation::startTrip(Car& car) {
+    car.active = std::move(car.queue.front().group);
+    car.queuedWork -= car.queue.front().plannedMs;
+    car.queue.pop_front();
+    car.activeDue = now + plannedTripTime(car.floor, car.active);
+    
+    int64_t pickupAt = now;
+    if (car.floor != car.active.fromFloor) {
+        pickupAt += travelMs(car.floor, car.active.fromFloor) + stopMs(car.active.size());
+        recordRun(car.floor, car.active.fromFloor, 0);
+        car.floor = car.active.fromFloor;
+    }
+    
+    car.phase = Phase::BOARDING;
+    car.eventAt = pickupAt + boardingHoldMs;
+}
+
+void Simulation::board(Car& car) {
+    int waiting = car.active.size();
+    int boarding = std::min(waiting, config.capacity - static_cast<int>(car.riders.size()));
+    car.queuedPassengers -= waiting;
+    
+    // Earliest arrivals board first; the rest wait for this car's next visit
+    for (int i = 0; i < boarding; i++) {
+        result.recordWait(now - car.active.arrivals[i]);
+        car.riders.push_back(car.active.arrivals[i]);
+    }
+    if (boarding < waiting) {
+        Group leftover{car.active.fromFloor, car.active.toFloor,
+                       std::vector<int64_t>(car.active.arrivals.begin() + boarding, car.active.arrivals.end())};
+        enqueue(car, std::move(leftover));
+    }
+    
+    recordRun(car.active.fromFloor, car.active.toFloor, boarding);
+    car.eventAt = now + travelMs(car.active.fromFloor, car.active.toFloor) + stopMs(boarding);
+    car.floor = car.active.toFloor;
+    car.phase = Phase::RIDING;
+}
+
+void Simulation::finishTrip(Car& car) {
+    for (int64_t arrival : car.riders) {
+        result.totalJourneySeconds += (now - arrival) / 1000.0;
+    }
+    result.passengers += car.riders.size();
+    car.riders.clear();
+    car.phase = Phase::IDLE;
+}
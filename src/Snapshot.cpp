@@ -0,0 +1,238 @@
+#include "Snapshot.h"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+static constexpr uint32_t SNAPSHOT_MAGIC = 0x534c5645;  // "EVLS" read little-endian
+static constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+namespace {
+
+class SnapshotWriter {
+private:
+    std::string& out;
+    
+public:
+    explicit SnapshotWriter(std::string& buffer) : out(buffer) {}
+    
+    void u8(uint8_t value) {
+        out.push_back(static_cast<char>(value));
+    }
+    
+    void u32(uint32_t value) {
+        for (int byte = 0; byte < 4; byte++) {
+            u8(static_cast<uint8_t>(value >> (byte * 8)));
+        }
+    }
+    
+    void i64(int64_t value) {
+        uint64_t bits = static_cast<uint64_t>(value);
+        for (int byte = 0; byte < 8; byte++) {
+            u8(static_cast<uint8_t>(bits >> (byte * 8)));
+        }
+    }
+    
+    void request(const Request& request) {
+        u32(static_cast<uint32_t>(request.fromFloor));
+        u32(static_cast<uint32_t>(request.toFloor));
+        u8(static_cast<uint8_t>(request.direction));
+        u32(static_cast<uint32_t>(request.passengers));
+        i64(std::chrono::duration_cast<std::chrono::milliseconds>(request.timestamp.time_since_epoch()).count());
+    }
+};
+
+// Reads fail softly: once past the end, every read returns 0 and ok() is false
+class SnapshotReader {
+private:
+    std::string_view in;
+    size_t offset = 0;
+    bool valid = true;
+    
+public:
+    explicit SnapshotReader(std::string_view data) : in(data) {}
+    
+    bool ok() const { return valid; }
+    bool atEnd() const { return offset == in.size(); }
+    
+    uint8_t u8() {
+        if (offset >= in.size()) {
+            valid = false;
+            return 0;
+        }
+        return static_cast<uint8_t>(in[offset++]);
+    }
+    
+    uint32_t u32() {
+        uint32_t value = 0;
+        for (int byte = 0; byte < 4; byte++) {
+            value |= static_cast<uint32_t>(u8()) << (byte * 8);
+        }
+        return value;
+    }
+    
+    int64_t i64() {
+        uint64_t bits = 0;
+        for (int byte = 0; byte < 8; byte++) {
+            bits |= static_cast<uint64_t>(u8()) << (byte * 8);
+        }
+        return static_cast<int64_t>(bits);
+    }
+    
+    // Counts are bounded by the bytes left so corrupt data cannot force a
+    // huge allocation
+    std::optional<uint32_t> count(size_t minBytesEach) {
+        uint32_t value = u32();
+        if (!valid || value > (in.size() - offset) / minBytesEach) {
+            valid = false;
+            return std::nullopt;
+        }
+        return value;
+    }
+    
+    Request request() {
+        int fromFloor = static_cast<int>(u32());
+        int toFloor = static_cast<int>(u32());
+        uint8_t direction = u8();
+        int passengers = static_cast<int>(u32());
+        int64_t timestampMs = i64();
+        
+        if (direction > static_cast<uint8_t>(Direction::DOWN)) {
+            valid = false;
+        }
+        
+        Request request(fromFloor, toFloor, static_cast<Direction>(direction), passengers);
+        request.timestamp = std::chrono::system_clock::time_point(std::chrono::milliseconds(timestampMs));
+        return request;
+    }
+};
+
+constexpr size_t REQUEST_BYTES = 4 + 4 + 1 + 4 + 8;
+constexpr size_t CAR_MIN_BYTES = 4 + 4 + 1 + 4;
+
+// FNV-1a, enough to catch torn or bit-rotted files
+uint32_t checksum(std::string_view data) {
+    uint32_t hash = 0x811c9dc5;
+    for (char c : data) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
+} // namespace
+
+std::string encodeSnapshot(const ControllerSnapshot& snapshot) {
+    std::string out;
+    SnapshotWriter writer(out);
+    
+    writer.u32(SNAPSHOT_MAGIC);
+    writer.u32(SNAPSHOT_VERSION);
+    writer.u32(static_cast<uint32_t>(snapshot.floors));
+    writer.u8(static_cast<uint8_t>(snapshot.dispatchMode));
+    
+    writer.u32(static_cast<uint32_t>(snapshot.cars.size()));
+    for (const auto& car : snapshot.cars) {
+        writer.u32(static_cast<uint32_t>(car.id));
+        writer.u32(static_cast<uint32_t>(car.floor));
+        writer.u8(car.emergency ? 1 : 0);
+        writer.u32(static_cast<uint32_t>(car.requests.size()));
+        for (const auto& request : car.requests) {
+            writer.request(request);
+        }
+    }
+    
+    writer.u32(static_cast<uint32_t>(snapshot.pending.size()));
+    for (const auto& request : snapshot.pending) {
+        writer.request(request);
+    }
+    
+    writer.u32(checksum(out));
+    return out;
+}
+
+std::optional<ControllerSnapshot> decodeSnapshot(std::string_view data) {
+    if (data.size() < 4) {
+        return std::nullopt;
+    }
+    
+    std::string_view body = data.substr(0, data.size() - 4);
+    SnapshotReader trailer(data.substr(data.size() - 4));
+    if (trailer.u32() != checksum(body)) {
+        return std::nullopt;
+    }
+    
+    SnapshotReader reader(body);
+    if (reader.u32() != SNAPSHOT_MAGIC || reader.u32() != SNAPSHOT_VERSION) {
+        return std::nullopt;
+    }
+    
+    ControllerSnapshot snapshot;
+    snapshot.floors = static_cast<int>(reader.u32());
+    uint8_t mode = reader.u8();
+    if (mode > static_cast<uint8_t>(DispatchMode::DESTINATION)) {
+        return std::nullopt;
+    }
+    snapshot.dispatchMode = static_cast<DispatchMode>(mode);
+    
+    auto carCount = reader.count(CAR_MIN_BYTES);
+    for (uint32_t i = 0; carCount && i < *carCount && reader.ok(); i++) {
+        CarSnapshot car;
+        car.id = static_cast<int>(reader.u32());
+        car.floor = static_cast<int>(reader.u32());
+        car.emergency = reader.u8() != 0;
+        
+        auto requestCount = reader.count(REQUEST_BYTES);
+        for (uint32_t j = 0; requestCount && j < *requestCount && reader.ok(); j++) {
+            car.requests.push_back(reader.request());
+        }
+        snapshot.cars.push_back(std::move(car));
+    }
+    
+    auto pendingCount = reader.count(REQUEST_BYTES);
+    for (uint32_t i = 0; pendingCount && i < *pendingCount && reader.ok(); i++) {
+        snapshot.pending.push_back(reader.request());
+    }
+    
+    if (!reader.ok() || !reader.atEnd()) {
+        return std::nullopt;
+    }
+    
+    return snapshot;
+}
+
+bool writeSnapshotFile(const std::string& path, const ControllerSnapshot& snapshot) {
+    std::string data = encodeSnapshot(snapshot);
+    std::string tempPath = path + ".tmp";
+    
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file || !file.write(data.data(), static_cast<std::streamsize>(data.size())) || !file.flush()) {
+            std::cerr << "Error writing checkpoint " << tempPath << std::endl;
+            return false;
+        }
+    }
+    
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "Error replacing checkpoint " << path << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    
+    return true;
+}
+
+std::optional<ControllerSnapshot> readSnapshotFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+    
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    auto snapshot = decodeSnapshot(data);
+    if (!snapshot) {
+        std::cerr << "Ignoring unreadable checkpoint " << path << std::endl;
+    }
+    return snapshot;
+}
@@ -0,0 +1,157 @@
+#include "Trace.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+void Tracer::setEnabled(bool enable) {
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+void Tracer::setOutputPath(const std::string& path) {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    outputPath = path;
+}
+
+std::string Tracer::getOutputPath() const {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    return outputPath;
+}
+
+Tracer::ThreadBufferHandle::~ThreadBufferHandle() {
+    if (buffer) {
+        Tracer::instance().releaseBuffer(*buffer);
+    }
+}
+
+Tracer::ThreadBuffer& Tracer::localBuffer() {
+    thread_local ThreadBufferHandle handle;
+    
+    if (!handle.buffer) {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        
+        // Reuse a buffer left behind by an exited thread so short-lived
+        // threads (e.g. client connections) do not grow the list forever
+        for (auto& buffer : buffers) {
+            if (!buffer->inUse) {
+                buffer->inUse = true;
+                buffer->threadId = nextThreadId++;
+                buffer->threadName.clear();
+                buffer->head.store(0, std::memory_order_relaxed);
+                handle.buffer = buffer;
+                break;
+            }
+        }
+        
+        if (!handle.buffer) {
+            handle.buffer = std::make_shared<ThreadBuffer>();
+            handle.buffer->threadId = nextThreadId++;
+            buffers.push_back(handle.buffer);
+        }
+    }
+    
+    return *handle.buffer;
+}
+
+void Tracer::releaseBuffer(ThreadBuffer& buffer) {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    buffer.inUse = false;
+}
+
+void Tracer::setThreadName(const std::string& name) {
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    buffer.threadName = name;
+}
+
+void Tracer::record(const char* name, uint64_t startNs, uint64_t endNs) {
+    ThreadBuffer& buffer = localBuffer();
+    
+    uint64_t index = buffer.head.load(std::memory_order_relaxed);
+    auto& slot = buffer.slots[index % EVENTS_PER_THREAD];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.startNs.store(startNs, std::memory_order_relaxed);
+    slot.endNs.store(endNs, std::memory_order_relaxed);
+    buffer.head.store(index + 1, std::memory_order_release);
+}
+
+long Tracer::dump() const {
+    struct Span {
+        const char* name;
+        uint64_t startNs;
+        uint64_t endNs;
+        uint32_t threadId;
+    };
+    std::vector<Span> spans;
+    std::vector<std::pair<uint32_t, std::string>> threadNames;
+    std::string path;
+    
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        path = outputPath;
+        
+        for (const auto& buffer : buffers) {
+            threadNames.emplace_back(buffer->threadId, buffer->threadName);
+            
+            uint64_t end = buffer->head.load(std::memory_order_acquire);
+            uint64_t begin = end > EVENTS_PER_THREAD ? end - EVENTS_PER_THREAD : 0;
+            size_t firstSpan = spans.size();
+            
+            for (uint64_t i = begin; i < end; i++) {
+                const auto& slot = buffer->slots[i % EVENTS_PER_THREAD];
+                spans.push_back(Span{
+                    slot.name.load(std::memory_order_relaxed),
+                    slot.startNs.load(std::memory_order_relaxed),
+                    slot.endNs.load(std::memory_order_relaxed),
+                    buffer->threadId
+                });
+            }
+            
+            // The owning thread kept writing while we copied; drop every slot
+            // it could have overwritten in the meantime
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t newEnd = buffer->head.load(std::memory_order_relaxed);
+            uint64_t safeBegin = newEnd > EVENTS_PER_THREAD ? newEnd - EVENTS_PER_THREAD : 0;
+            if (safeBegin > begin) {
+                size_t lapped = static_cast<size_t>(std::min(safeBegin - begin, end - begin));
+                spans.erase(spans.begin() + firstSpan, spans.begin() + firstSpan + lapped);
+            }
+        }
+    }
+    
+    std::ofstream out(path);
+    if (!out) {
+        return -1;
+    }
+    
+    // Chrome trace event format: complete ("X") events with microsecond
+    // timestamps, plus thread_name metadata so lanes are labelled
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto& [threadId, threadName] : threadNames) {
+        if (threadName.empty()) {
+            continue;
+        }
+        out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadId
+            << ",\"args\":{\"name\":\"" << threadName << "\"}}";
+        first = false;
+    }
+    
+    out << std::fixed << std::setprecision(3);
+    for (const auto& span : spans) {
+        if (!span.name) {
+            continue;
+        }
+        out << (first ? "" : ",") << "\n{\"name\":\"" << span.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << span.threadId
+            << ",\"ts\":" << static_cast<double>(span.startNs) / 1000.0
+            << ",\"dur\":" << static_cast<double>(span.endNs - span.startNs) / 1000.0 << "}";
+        first = false;
+    }
+    out << "\n]}\n";
+    
+    return static_cast<long>(spans.size());
+}
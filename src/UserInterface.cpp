@@ -1,10 +1,14 @@
 #include "UserInterface.h"
+#include "EnumStrings.h"
 #include <iostream>
 #include <iomanip>
 #include <sstream>
 #include <string>
 #include <thread>
 #include <chrono>
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
 
 UserInterface::UserInterface(ElevatorController& elevatorController)
     : controller(elevatorController), running(false) {
@@ -21,6 +25,10 @@ void UserInterface::start() {
     
     running = true;
     
+    // Redraw when a car moves or a door changes rather than on a fixed tick
+    displayEvents = controller.getEventBus().subscribe(
+        EventBus::ALL_EVENTS & ~EventBus::typeBit(LogEventType::SYNC_EVENT));
+    
     // Start input thread
     inputThread = std::thread(&UserInterface::inputLoop, this);
     
@@ -32,36 +40,81 @@ void UserInterface::start() {
 }
 
 void UserInterface::stop() {
-    if (!running) {
-        return;
-    }
-    
+    // The 'exit' command clears running from the input thread, so join
+    // whatever is still joinable rather than returning early
     running = false;
+    if (displayEvents) {
+        displayEvents->wake();
+    }
     
-    // Wait for threads to finish
-    if (inputThread.joinable()) {
+    // Wait for threads to finish; the input thread polls stdin, so it
+    // notices within INPUT_POLL_INTERVAL even if nothing is typed
+    if (inputThread.joinable() && inputThread.get_id() != std::this_thread::get_id()) {
         inputThread.join();
     }
     
     if (displayThread.joinable()) {
         displayThread.join();
     }
+    
+    if (displayEvents) {
+        controller.getEventBus().unsubscribe(displayEvents);
+        displayEvents.reset();
+    }
+}
+
+bool UserInterface::readLine(std::string& line) {
+    while (running) {
+        size_t newline = inputBuffer.find('\n');
+        if (newline != std::string::npos) {
+            line.assign(inputBuffer, 0, newline);
+            inputBuffer.erase(0, newline + 1);
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            return true;
+        }
+        if (inputClosed) {
+            // A last line without a newline still counts
+            line.swap(inputBuffer);
+            inputBuffer.clear();
+            return !line.empty();
+        }
+        
+        struct pollfd input = {STDIN_FILENO, POLLIN, 0};
+        int ready = poll(&input, 1, static_cast<int>(INPUT_POLL_INTERVAL.count()));
+        if (ready < 0 && errno != EINTR) {
+            inputClosed = true;
+        }
+        if (ready <= 0) {
+            continue;
+        }
+        
+        char buffer[256];
+        ssize_t bytesRead = read(STDIN_FILENO, buffer, sizeof(buffer));
+        if (bytesRead > 0) {
+            inputBuffer.append(buffer, static_cast<size_t>(bytesRead));
+        } else if (bytesRead == 0 || (errno != EINTR && errno != EAGAIN)) {
+            inputClosed = true;
+        }
+    }
+    return false;
 }
 
 void UserInterface::inputLoop() {
     std::string command;
     
     while (running) {
-        std::cout << "> ";
-        std::getline(std::cin, command);
+        std::cout << "> " << std::flush;
         
-        if (!running) {
+        // At end of input the display and server carry on without commands
+        if (!readLine(command)) {
             break;
         }
         
         // Process the command in a way that doesn't get immediately overwritten
         {
-            std::lock_guard<std::mutex> lock(displayMutex);
+            std::lock_guard<ProfiledMutex> lock(displayMutex);
             processCommand(command);
             // Add a small delay to make sure the response is visible
             std::this_thread::sleep_for(std::chrono::milliseconds(500));
@@ -72,19 +125,31 @@ void UserInterface::inputLoop() {
 void UserInterface::displayLoop() {
     // Initial display
     displayStatus();
+    auto lastDraw = std::chrono::steady_clock::now();
     
     while (running) {
-        // Update the display every 1 second to match the elevator speed
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        // Still redraw once a second, so the view never goes stale
+        displayEvents->waitFor(std::chrono::seconds(1));
         
         if (!running) {
             break;
         }
         
+        EventRecord event;
+        while (displayEvents->poll(event)) {
+        }
+        
+        // Coalesce bursts of events (several cars passing floors) into one redraw
+        auto sinceDraw = std::chrono::steady_clock::now() - lastDraw;
+        if (sinceDraw < MIN_REDRAW_INTERVAL) {
+            std::this_thread::sleep_for(MIN_REDRAW_INTERVAL - sinceDraw);
+        }
+        
         {
-            std::lock_guard<std::mutex> lock(displayMutex);
+            std::lock_guard<ProfiledMutex> lock(displayMutex);
             displayStatus();
         }
+        lastDraw = std::chrono::steady_clock::now();
     }
 }
 
@@ -97,12 +162,20 @@ void UserInterface::displayStatus() {
     #endif
     
     // ANSI color codes
-    const std::string RESET = "\033[0m";
-    const std::string BOLD = "\033[1m";
-    const std::string BLUE = "\033[34m";
-    const std::string GREEN = "\033[32m";
-    const std::string YELLOW = "\033[33m";
-    const std::string RED = "\033[31m";
+    constexpr const char* RESET = "\033[0m";
+    constexpr const char* BOLD = "\033[1m";
+    constexpr const char* BLUE = "\033[34m";
+    constexpr const char* GREEN = "\033[32m";
+    constexpr const char* YELLOW = "\033[33m";
+    constexpr const char* RED = "\033[31m";
+    
+    // Colors indexed by Direction and ElevatorStatus, parallel to the name tables
+    constexpr std::array<const char*, DIRECTION_NAMES.size()> DIRECTION_COLORS = {
+        RESET, GREEN, YELLOW
+    };
+    constexpr std::array<const char*, ELEVATOR_STATUS_NAMES.size()> STATUS_COLORS = {
+        RESET, GREEN, BLUE, RED
+    };
     
     // Get current time
     auto now = std::chrono::system_clock::now();
@@ -126,51 +199,23 @@ void UserInterface::displayStatus() {
     auto statuses = controller.getElevatorStatuses();
     
     for (const auto& [id, currentFloor, destFloor, direction, status] : statuses) {
-        std::string dirStr;
-        std::string colorCode;
-        
-        switch (direction) {
-            case Direction::IDLE: 
-                dirStr = "Idle"; 
-                colorCode = RESET;
-                break;
-            case Direction::UP: 
-                dirStr = "Up"; 
-                colorCode = GREEN;
-                break;
-            case Direction::DOWN: 
-                dirStr = "Down"; 
-                colorCode = YELLOW;
-                break;
-        }
-        
-        std::string statusStr;
-        std::string statusColor;
-        
-        switch (status) {
-            case ElevatorStatus::IDLE: 
-                statusStr = "Idle"; 
-                statusColor = RESET;
-                break;
-            case ElevatorStatus::MOVING: 
-                statusStr = "Moving"; 
-                statusColor = GREEN;
-                break;
-            case ElevatorStatus::STOPPED: 
-                statusStr = "Stopped"; 
-                statusColor = BLUE;
-                break;
-            case ElevatorStatus::EMERGENCY: 
-                statusStr = "EMERGENCY"; 
-                statusColor = RED;
-                break;
-        }
-        
         std::cout << BLUE << std::setw(10) << "#" + std::to_string(id) << RESET << " | "
-                  << std::setw(14) << currentFloor << " | "
-                  << std::setw(12) << (direction == Direction::IDLE ? "--" : std::to_string(destFloor)) << " | "
-                  << colorCode << std::setw(10) << dirStr << RESET << " | "
-                  << statusColor << std::setw(10) << statusStr << RESET << std::endl;
+                  << std::setw(14) << currentFloor << " | ";
+        if (direction == Direction::IDLE) {
+            std::cout << std::setw(12) << "--";
+        } else {
+            std::cout << std::setw(12) << destFloor;
+        }
+        std::cout << " | "
+                  << DIRECTION_COLORS[static_cast<size_t>(direction)] << std::setw(10) << toString(direction) << RESET << " | "
+                  << STATUS_COLORS[static_cast<size_t>(status)] << std::setw(10) << toString(status) << RESET << std::endl;
+    }
+    
+    // Display the latest events straight from the controller's in-memory ring
+    std::cout << std::endl;
+    std::cout << BOLD << "Recent events:" << RESET << std::endl;
+    for (const auto& event : controller.getRecentEvents(RECENT_EVENTS_SHOWN)) {
+        std::cout << "  " << formatEventRecord(event) << std::endl;
     }
     
     std::cout << std::endl;
@@ -178,7 +223,7 @@ void UserInterface::displayStatus() {
 }
 
 void UserInterface::displayHelp() {
-    std::lock_guard<std::mutex> lock(displayMutex);
+    std::lock_guard<ProfiledMutex> lock(displayMutex);
     
     std::cout << "\n=== Available Commands ===" << std::endl;
     std::cout << "call <floor> <direction>  - Request an elevator to a floor (direction: up/down)" << std::endl;
@@ -200,19 +245,16 @@ void UserInterface::processCommand(const std::string& command) {
         std::string dirStr;
         
         if (iss >> floor >> dirStr) {
-            Direction dir = Direction::IDLE;
-            
-            if (dirStr == "up") {
-                dir = Direction::UP;
-            } else if (dirStr == "down") {
-                dir = Direction::DOWN;
-            } else {
+            auto parsed = parseDirection(dirStr);
+            if (!parsed || *parsed == Direction::IDLE) {
                 std::cout << "Invalid direction. Use 'up' or 'down'." << std::endl;
                 return;
             }
+            Direction dir = *parsed;
             
-            controller.addRequest(floor, 0, dir);
-            std::cout << "Elevator requested at floor " << floor << " going " << dirStr << std::endl;
+            if (controller.addRequest(floor, 0, dir)) {
+                std::cout << "Elevator requested at floor " << floor << " going " << dirStr << std::endl;
+            }
         } else {
             std::cout << "Invalid command format. Use 'call <floor> <direction>'" << std::endl;
         }
@@ -226,9 +268,10 @@ void UserInterface::processCommand(const std::string& command) {
             
             for (const auto& [id, currentFloor, destFloor, direction, status] : statuses) {
                 if (status == ElevatorStatus::IDLE || status == ElevatorStatus::STOPPED) {
-                    controller.addRequest(currentFloor, floor, 
-                        floor > currentFloor ? Direction::UP : Direction::DOWN);
-                    std::cout << "Elevator #" << id << " will go to floor " << floor << std::endl;
+                    if (controller.addRequest(currentFloor, floor, 
+                            floor > currentFloor ? Direction::UP : Direction::DOWN)) {
+                        std::cout << "Elevator #" << id << " will go to floor " << floor << std::endl;
+                    }
                     requestSent = true;
                     break;
                 }
@@ -1,13 +1,24 @@
-#include "ElevatorController.h"
+#include "ShardedController.h"
+#include "DatabaseLogger.h"
 #include "UserInterface.h"
 #include "DemoRunner.h"
+#include "ExperimentRunner.h"
 #include "ElevatorServer.h"
+#include "Trace.h"
+#include "EnumStrings.h"
+#include "ProfiledMutex.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <optional>
+#include <random>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <csignal>
 
 // Global controller for signal handling
-ElevatorController* globalController = nullptr;
+ShardedController* globalController = nullptr;
 ElevatorServer* globalServer = nullptr;
 
 // Signal handler for graceful shutdown
@@ -22,6 +33,8 @@ void signalHandler(int signal) {
         globalController->stop();
     }
     
+    std::cout << LockProfiler::instance().formatReport();
+    
     exit(signal);
 }
 
@@ -31,6 +44,27 @@ int main(int argc, char* argv[]) {
     bool runDemo = false;
     bool enableServer = true;  // Enable server by default
     int serverPort = 8081;      // Default server port
+    int maxClients = 64;        // Concurrent client connections
+    int idleTimeoutSec = 300;   // Disconnect clients idle this long
+    int metricsPort = 8082;     // HTTP /metrics and /status, 0 to disable
+    std::string traceFile;      // Record spans from startup and dump here on exit
+    std::string shardSpec;      // name:cars:floors,... for several banks/buildings
+    std::vector<std::string> carFloorSpecs;  // cars=floors zone/express restrictions
+    int capacity = Elevator::DEFAULT_CAPACITY;  // Passengers per car
+    DispatchMode dispatchMode = DispatchMode::CONVENTIONAL;
+    bool reassignCalls = true;  // Move queued calls to a car that arrives sooner
+    bool parkIdleCars = false;  // Spread idle cars by learned demand
+    bool pinDispatchers = false;  // Pin each shard's dispatcher to its own CPU
+    KinematicConfig kinematics;  // Motion limits, storey heights, door timings
+    std::string experimentSpec;  // Parameter grid for a batch of headless simulations
+    std::string experimentOut;   // CSV destination, stdout if empty
+    int jobs = 0;                // Experiment worker threads, 0 for every core
+    std::optional<uint64_t> seed;  // Seed for the demo and experiments; random if unset
+    std::string checkpointFile;  // Restore from and periodically save controller state
+    std::string restoreFile;     // Start from this checkpoint instead (fork a saved run)
+    int checkpointIntervalSec = 5;
+    std::string dbSpillFile;     // Database events kept here while PostgreSQL is down
+    std::string eventSinkSpec = "postgres";  // postgres, memory, null or journal:FILE
     
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -46,6 +80,62 @@ int main(int argc, char* argv[]) {
             enableServer = false;
         } else if (arg == "--port" && i + 1 < argc) {
             serverPort = std::stoi(argv[++i]);
+        } else if (arg == "--max-clients" && i + 1 < argc) {
+            maxClients = std::stoi(argv[++i]);
+        } else if (arg == "--idle-timeout" && i + 1 < argc) {
+            idleTimeoutSec = std::stoi(argv[++i]);
+        } else if (arg == "--metrics-port" && i + 1 < argc) {
+            metricsPort = std::stoi(argv[++i]);
+        } else if (arg == "--shards" && i + 1 < argc) {
+            shardSpec = argv[++i];
+        } else if (arg == "--dispatch" && i + 1 < argc) {
+            auto mode = parseDispatchMode(argv[++i]);
+            if (!mode) {
+                std::cerr << "Error: --dispatch must be 'conventional' or 'destination'" << std::endl;
+                return 1;
+            }
+            dispatchMode = *mode;
+        } else if (arg == "--no-reassign") {
+            reassignCalls = false;
+        } else if (arg == "--parking") {
+            parkIdleCars = true;
+        } else if (arg == "--pin-dispatchers") {
+            pinDispatchers = true;
+        } else if (arg == "--capacity" && i + 1 < argc) {
+            capacity = std::stoi(argv[++i]);
+        } else if (arg == "--max-speed" && i + 1 < argc) {
+            kinematics.motion.maxSpeed = std::stod(argv[++i]);
+        } else if (arg == "--floor-height" && i + 1 < argc) {
+            std::stringstream heights(argv[++i]);
+            std::string height;
+            kinematics.storeyHeights.clear();
+            while (std::getline(heights, height, ',')) {
+                kinematics.storeyHeights.push_back(std::stod(height));
+            }
+        } else if (arg == "--time-scale" && i + 1 < argc) {
+            kinematics.timeScale = std::stod(argv[++i]);
+        } else if (arg == "--experiment" && i + 1 < argc) {
+            experimentSpec = argv[++i];
+        } else if (arg == "--experiment-out" && i + 1 < argc) {
+            experimentOut = argv[++i];
+        } else if (arg == "--checkpoint" && i + 1 < argc) {
+            checkpointFile = argv[++i];
+        } else if (arg == "--checkpoint-interval" && i + 1 < argc) {
+            checkpointIntervalSec = std::stoi(argv[++i]);
+        } else if (arg == "--restore" && i + 1 < argc) {
+            restoreFile = argv[++i];
+        } else if (arg == "--db-spill" && i + 1 < argc) {
+            dbSpillFile = argv[++i];
+        } else if (arg == "--event-sink" && i + 1 < argc) {
+            eventSinkSpec = argv[++i];
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::stoull(argv[++i]);
+        } else if (arg == "--jobs" && i + 1 < argc) {
+            jobs = std::stoi(argv[++i]);
+        } else if (arg == "--car-floors" && i + 1 < argc) {
+            carFloorSpecs.push_back(argv[++i]);
+        } else if (arg == "--trace" && i + 1 < argc) {
+            traceFile = argv[++i];
         } else if (arg == "--help") {
             std::cout << "Usage: " << argv[0] << " [options]" << std::endl;
             std::cout << "Options:" << std::endl;
@@ -54,6 +144,32 @@ int main(int argc, char* argv[]) {
             std::cout << "  --demo           Run automated demo instead of interactive mode" << std::endl;
             std::cout << "  --no-server      Disable the network server" << std::endl;
             std::cout << "  --port N         Set server port (default: 8081)" << std::endl;
+            std::cout << "  --max-clients N  Maximum concurrent client connections (default: 64)" << std::endl;
+            std::cout << "  --idle-timeout S Disconnect clients idle for S seconds (default: 300)" << std::endl;
+            std::cout << "  --metrics-port N HTTP port for /metrics and /status, 0 to disable (default: 8082)" << std::endl;
+            std::cout << "  --shards SPEC    Run several banks/buildings, e.g. low:4:20,high:4:40 (name:cars:floors)" << std::endl;
+            std::cout << "                   Each shard has its own dispatcher; the UI and demo drive the first" << std::endl;
+            std::cout << "  --pin-dispatchers Pin shard i's dispatcher thread to the i-th allowed CPU" << std::endl;
+            std::cout << "  --dispatch MODE  conventional or destination (lobby keypads, grouped trips)" << std::endl;
+            std::cout << "  --no-reassign    Keep queued calls on the car first assigned, even if another gets there sooner" << std::endl;
+            std::cout << "  --parking        Send idle cars to the floors where calls are expected by time of day" << std::endl;
+            std::cout << "  --capacity N     Passengers each car can carry (default: " << Elevator::DEFAULT_CAPACITY << ")" << std::endl;
+            std::cout << "  --car-floors C=F Limit cars C to floors F, e.g. 2-3=1,20-40 (repeatable)" << std::endl;
+            std::cout << "  --max-speed V    Car top speed in m/s (default: " << kinematics.motion.maxSpeed << ")" << std::endl;
+            std::cout << "  --floor-height H Storey height in metres, or a list from floor 1 up, e.g. 5,3.5" << std::endl;
+            std::cout << "                   (the last height repeats; default: " << TravelTimeTable::DEFAULT_FLOOR_HEIGHT << ")" << std::endl;
+            std::cout << "  --time-scale X   Simulated seconds per real second (default: " << kinematics.timeScale << ")" << std::endl;
+            std::cout << "  --experiment GRID Run headless simulations over a parameter grid and print CSV, e.g." << std::endl;
+            std::cout << "                   policy=conventional,destination;cars=4,6;traffic=up-peak;runs=100" << std::endl;
+            std::cout << "  --experiment-out FILE  Write the experiment CSV to FILE instead of stdout" << std::endl;
+            std::cout << "  --jobs N         Experiment worker threads (default: every core)" << std::endl;
+            std::cout << "  --checkpoint FILE Resume from FILE if present and save state to it periodically and on exit" << std::endl;
+            std::cout << "  --checkpoint-interval S  Seconds between checkpoints (default: 5)" << std::endl;
+            std::cout << "  --restore FILE   Start from this checkpoint instead, e.g. to fork a saved run" << std::endl;
+            std::cout << "  --db-spill FILE  Keep database events in FILE while the database is unreachable" << std::endl;
+            std::cout << "  --event-sink S   Where events go: postgres, memory, null or journal:FILE (default: postgres)" << std::endl;
+            std::cout << "  --seed N         Seed every random choice of the demo and experiments (default: random)" << std::endl;
+            std::cout << "  --trace FILE     Record tracing spans and write them to FILE on exit" << std::endl;
             std::cout << "  --help           Display this help message" << std::endl;
             return 0;
         }
@@ -70,22 +186,158 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    if (capacity < 1) {
+        std::cerr << "Error: --capacity must be at least 1" << std::endl;
+        return 1;
+    }
+    
+    bool heightsValid = std::all_of(kinematics.storeyHeights.begin(), kinematics.storeyHeights.end(),
+                                    [](double height) { return height > 0.0; });
+    if (kinematics.motion.maxSpeed <= 0.0 || kinematics.timeScale <= 0.0 || !heightsValid) {
+        std::cerr << "Error: --max-speed, --floor-height and --time-scale must be positive" << std::endl;
+        return 1;
+    }
+    
+    if (!experimentSpec.empty()) {
+        auto grid = parseExperimentGrid(experimentSpec);
+        if (!grid || jobs < 0) {
+            std::cerr << "Error: --experiment expects key=values pairs separated by ';' with keys policy, cars, "
+                      << "capacity, traffic, floors, runs, seed, rate and hours" << std::endl;
+            return 1;
+        }
+        grid->kinematics = kinematics;
+        // A seed= entry in the grid takes precedence over --seed
+        if (seed && !grid->firstSeed) {
+            grid->firstSeed = *seed;
+        }
+        
+        ExperimentRunner runner(*grid, static_cast<unsigned>(jobs));
+        std::cerr << "Running " << runner.getRunCount() << " simulations on "
+                  << runner.getJobCount() << " threads" << std::endl;
+        auto started = std::chrono::steady_clock::now();
+        auto rows = runner.run();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+        
+        if (experimentOut.empty()) {
+            ExperimentRunner::writeCsv(std::cout, rows);
+        } else {
+            std::ofstream file(experimentOut);
+            if (!file) {
+                std::cerr << "Error: cannot write " << experimentOut << std::endl;
+                return 1;
+            }
+            ExperimentRunner::writeCsv(file, rows);
+        }
+        std::cerr << "Finished in " << elapsed.count() << " s" << std::endl;
+        return 0;
+    }
+    
+    if (checkpointIntervalSec < 1) {
+        std::cerr << "Error: --checkpoint-interval must be at least 1" << std::endl;
+        return 1;
+    }
+    
+    bool journalSink = eventSinkSpec.rfind("journal:", 0) == 0 && eventSinkSpec.size() > 8;
+    if (eventSinkSpec != "postgres" && eventSinkSpec != "memory" && eventSinkSpec != "null" && !journalSink) {
+        std::cerr << "Error: --event-sink must be postgres, memory, null or journal:FILE" << std::endl;
+        return 1;
+    }
+    
+    if (maxClients < 1 || idleTimeoutSec < 1) {
+        std::cerr << "Error: --max-clients and --idle-timeout must be at least 1" << std::endl;
+        return 1;
+    }
+    
+    std::vector<ShardConfig> shardConfigs{ShardConfig{"main", numElevators, numFloors}};
+    if (!shardSpec.empty()) {
+        auto parsed = parseShardSpec(shardSpec);
+        if (!parsed) {
+            std::cerr << "Error: --shards expects name:cars:floors[,name:cars:floors...] with unique names "
+                      << "of letters, digits, '_' and '-', at least 1 car and 2 floors per shard" << std::endl;
+            return 1;
+        }
+        shardConfigs = *parsed;
+        numElevators = shardConfigs[0].elevators;
+        numFloors = shardConfigs[0].floors;
+    }
+    
+    if (!traceFile.empty()) {
+        Tracer::instance().setOutputPath(traceFile);
+        Tracer::instance().setEnabled(true);
+    }
+    
     // Set up signal handlers
     std::signal(SIGINT, signalHandler);
     std::signal(SIGTERM, signalHandler);
     
     try {
-        // Create elevator controller
-        ElevatorController controller(numElevators, numFloors);
-        globalController = &controller;
+        // Each shard gets its own sink; files are suffixed per shard
+        auto makeEventSink = [&](size_t shardId) -> std::unique_ptr<EventSink> {
+            if (eventSinkSpec == "null") {
+                return std::make_unique<NullEventSink>();
+            }
+            if (eventSinkSpec == "memory") {
+                return std::make_unique<MemoryEventSink>();
+            }
+            if (journalSink) {
+                return std::make_unique<JournalEventSink>(getShardPath(eventSinkSpec.substr(8), shardConfigs, shardId));
+            }
+            
+            auto logger = std::make_unique<DatabaseLogger>();
+            if (!dbSpillFile.empty()) {
+                logger->setSpillFile(getShardPath(dbSpillFile, shardConfigs, shardId));
+            }
+            return logger;
+        };
+        
+        // Create one controller per shard; the UI and demo drive the first
+        ShardedController shards(shardConfigs, pinDispatchers, makeEventSink);
+        ElevatorController& controller = shards.getShard(0);
+        globalController = &shards;
         
-        // Start the controller
-        controller.start();
+        shards.setCapacity(capacity);
+        shards.setKinematics(kinematics);
+        shards.setDispatchMode(dispatchMode);
+        shards.setCallReassignment(reassignCalls);
+        shards.setParkingPolicy(parkIdleCars);
+        
+        for (const auto& spec : carFloorSpecs) {
+            if (!shards.applyServedFloorsSpec(spec)) {
+                std::cerr << "Error: invalid --car-floors '" << spec << "'; expected cars=floors "
+                          << "with car ids and floors of an existing shard, e.g. 2-3=1,20-40" << std::endl;
+                return 1;
+            }
+        }
+        
+        // Resume calls that were queued when the last run stopped
+        std::string resumeFrom = restoreFile.empty() ? checkpointFile : restoreFile;
+        if (!resumeFrom.empty()) {
+            size_t restored = shards.restoreCheckpoint(resumeFrom);
+            if (restored > 0) {
+                std::cout << "Restored " << restored << " shard(s) from checkpoint " << resumeFrom << std::endl;
+            } else if (!restoreFile.empty()) {
+                std::cerr << "Error: no usable checkpoint at " << restoreFile << std::endl;
+                return 1;
+            }
+        }
+        if (!checkpointFile.empty()) {
+            shards.setCheckpointFile(checkpointFile, std::chrono::seconds(checkpointIntervalSec));
+        }
+        
+        // Start the controllers
+        shards.start();
+        if (shards.getShardCount() > 1) {
+            std::cout << "Started " << shards.getShardCount() << " shards with "
+                      << shards.getTotalElevators() << " elevators in total" << std::endl;
+        }
         
         // Start the network server if enabled
         ElevatorServer* server = nullptr;
         if (enableServer) {
-            server = new ElevatorServer(controller, serverPort);
+            server = new ElevatorServer(shards, serverPort);
+            server->setMaxConnections(maxClients);
+            server->setIdleTimeout(std::chrono::seconds(idleTimeoutSec));
+            server->setMetricsPort(metricsPort);
             globalServer = server;
             
             if (!server->start()) {
@@ -106,8 +358,11 @@ int main(int argc, char* argv[]) {
             UserInterface ui(controller);
             ui.start();
             
-            // Create and start demo runner
-            DemoRunner demo(controller);
+            // Create and start demo runner. Its requests replay exactly for
+            // a given seed, though car timing still follows the wall clock.
+            uint64_t demoSeed = seed ? *seed : std::random_device()();
+            std::cout << "Demo seed: " << demoSeed << " (repeat with --seed " << demoSeed << ")" << std::endl;
+            DemoRunner demo(controller, demoSeed);
             demo.start();
             
             // Wait for demo to complete or user to exit
@@ -136,7 +391,14 @@ int main(int argc, char* argv[]) {
             globalServer = nullptr;
         }
         
-        controller.stop();
+        shards.stop();
+        
+        std::cout << LockProfiler::instance().formatReport();
+        
+        if (!traceFile.empty()) {
+            long spans = Tracer::instance().dump();
+            std::cout << "Wrote " << spans << " trace spans to " << traceFile << std::endl;
+        }
         
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
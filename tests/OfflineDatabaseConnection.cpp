@@ -0,0 +1,70 @@
+#include "DatabaseConnection.h"
+#include "EnumStrings.h"
+#include <algorithm>
+#include <ctime>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+// Stands in for src/PostgresConnection.cpp in the test build, which does not
+// link libpqxx. Every connection opens and keeps its own tables in memory.
+class OfflineDatabaseConnection : public DatabaseConnection {
+public:
+    bool isOpen() const override { return true; }
+    std::string describe() const override { return "offline as test"; }
+    void createSchema() override {}
+    
+    void insertLog(LogEventType eventType, int elevatorId, int fromFloor, int toFloor) override {
+        logs.push_back({eventType, elevatorId, fromFloor, toFloor, std::chrono::system_clock::now()});
+    }
+    
+    void insertLogs(const std::deque<LogEntry>& entries) override {
+        logs.insert(logs.end(), entries.begin(), entries.end());
+    }
+    
+    void upsertElevator(int elevatorId, int currentFloor, int destFloor, int direction, int status) override {
+        elevators[elevatorId] = EventSink::ElevatorState(elevatorId, currentFloor, destFloor,
+                                                         static_cast<Direction>(direction),
+                                                         static_cast<ElevatorStatus>(status));
+    }
+    
+    std::vector<EventSink::ElevatorState> selectElevators() override {
+        std::vector<EventSink::ElevatorState> states;
+        for (const auto& [id, state] : elevators) {
+            states.push_back(state);
+        }
+        return states;
+    }
+    
+    std::vector<EventSink::LogRow> selectRecentLogs(int limit, std::chrono::system_clock::time_point before) override {
+        std::vector<LogEntry> sorted(logs.begin(), logs.end());
+        std::stable_sort(sorted.begin(), sorted.end(),
+                         [](const LogEntry& a, const LogEntry& b) { return a.time > b.time; });
+        
+        std::vector<EventSink::LogRow> rows;
+        for (const auto& entry : sorted) {
+            if (static_cast<int>(rows.size()) >= limit) {
+                break;
+            }
+            if (entry.time >= before) {
+                continue;
+            }
+            std::time_t seconds = std::chrono::system_clock::to_time_t(entry.time);
+            std::tm localTime;
+            localtime_r(&seconds, &localTime);
+            std::stringstream ss;
+            ss << std::put_time(&localTime, "%Y-%m-%d %H:%M:%S");
+            rows.emplace_back(ss.str(), std::string(toString(entry.eventType)), entry.elevatorId,
+                              entry.fromFloor, entry.toFloor);
+        }
+        return rows;
+    }
+
+private:
+    std::deque<LogEntry> logs;
+    std::map<int, EventSink::ElevatorState> elevators;
+};
+
+std::unique_ptr<DatabaseConnection> openDatabaseConnection(const std::string& /*options*/) {
+    return std::make_unique<OfflineDatabaseConnection>();
+}
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include "ArrivalStats.h"
+#include <chrono>
+#include <vector>
+
+class ArrivalStatsTest : public ::testing::Test {
+protected:
+    std::chrono::system_clock::time_point today = std::chrono::system_clock::now();
+    std::chrono::hours day{24};
+};
+
+TEST_F(ArrivalStatsTest, CountsCallsInTheCurrentSlot) {
+    ArrivalStats stats(10);
+    std::vector<double> rates;
+    
+    stats.getRates(today, rates);
+    ASSERT_EQ(rates.size(), 11u);
+    EXPECT_EQ(rates[1], 0.0);
+    
+    stats.record(1, today);
+    stats.record(1, today);
+    stats.record(7, today);
+    stats.record(11, today);  // Out of range, ignored
+    EXPECT_EQ(stats.getRecordedCount(), 3u);
+    
+    stats.getRates(today, rates);
+    EXPECT_DOUBLE_EQ(rates[1], 2.0);
+    EXPECT_DOUBLE_EQ(rates[7], 1.0);
+    EXPECT_DOUBLE_EQ(rates[4], 0.0);
+}
+
+TEST_F(ArrivalStatsTest, LearnsTheSameTimeOnLaterDays) {
+    ArrivalStats stats(10, 0.5);
+    for (int i = 0; i < 8; i++) {
+        stats.record(1, today);
+    }
+    stats.record(6, today);
+    
+    // Half a day later the slot has no history and the last slot was empty
+    std::vector<double> rates;
+    stats.getRates(today + std::chrono::hours(12), rates);
+    EXPECT_EQ(rates[1], 0.0);
+    
+    // The next day the lobby is expected to be busy again before any call
+    stats.getRates(today + day, rates);
+    EXPECT_GT(rates[1], rates[6]);
+    EXPECT_GT(rates[6], 0.0);
+    double firstDay = rates[1];
+    
+    // A quiet second day halves the lobby's weight at smoothing 0.5
+    stats.getRates(today + 2 * day, rates);
+    EXPECT_NEAR(rates[1], firstDay / 2, 1e-9);
+}
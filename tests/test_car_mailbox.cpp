@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include "CarMailbox.h"
+#include <chrono>
+#include <thread>
+
+TEST(CarMailboxTest, CommandsAccumulateUntilTaken) {
+    CarMailbox mailbox;
+    EXPECT_EQ(mailbox.take(), 0u);
+    
+    mailbox.post(CarMailbox::WORK);
+    mailbox.post(CarMailbox::RELEASE);
+    mailbox.post(CarMailbox::WORK);
+    
+    EXPECT_EQ(mailbox.take(), CarMailbox::WORK | CarMailbox::RELEASE);
+    EXPECT_EQ(mailbox.take(), 0u);
+}
+
+TEST(CarMailboxTest, PostBeforeWaitIsNotLost) {
+    CarMailbox mailbox;
+    mailbox.post(CarMailbox::SHUTDOWN);
+    
+    // Already posted: returns without parking
+    EXPECT_EQ(mailbox.wait(), CarMailbox::SHUTDOWN);
+    EXPECT_EQ(mailbox.getParkCount(), 0u);
+}
+
+TEST(CarMailboxTest, WaitUntilTimesOut) {
+    CarMailbox mailbox;
+    
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(mailbox.waitUntil(start + std::chrono::milliseconds(20)), 0u);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+}
+
+TEST(CarMailboxTest, PostWakesParkedCar) {
+    CarMailbox mailbox;
+    
+    std::thread poster([&mailbox] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        mailbox.post(CarMailbox::EMERGENCY);
+    });
+    
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(mailbox.waitUntil(start + std::chrono::seconds(5)), CarMailbox::EMERGENCY);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+    EXPECT_GE(mailbox.getParkCount(), 1u);
+    poster.join();
+}
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include "ElevatorController.h"
+#include "EventSink.h"
+#include "Snapshot.h"
+#include <atomic>
 #include <thread>
 #include <chrono>
 #include <cstdlib> // For std::getenv
@@ -19,7 +22,7 @@ TEST_F(ControllerTest, InitialState) {
     if (std::getenv("CI") != nullptr) {
         GTEST_SKIP() << "Skipping test that requires a running server in CI environment";
     }
-    ElevatorController controller(3, 10);
+    ElevatorController controller(3, 10, 0, std::make_unique<NullEventSink>());
     
     EXPECT_EQ(controller.getNumElevators(), 3);
     EXPECT_EQ(controller.getNumFloors(), 10);
@@ -38,7 +41,7 @@ TEST_F(ControllerTest, AddRequest) {
     if (std::getenv("CI") != nullptr) {
         GTEST_SKIP() << "Skipping test that requires a running server in CI environment";
     }
-    ElevatorController controller(1, 10);
+    ElevatorController controller(1, 10, 0, std::make_unique<NullEventSink>());
     controller.start();
     
     // Add a request to go to floor 5
@@ -61,7 +64,7 @@ TEST_F(ControllerTest, EmergencyStop) {
     if (std::getenv("CI") != nullptr) {
         GTEST_SKIP() << "Skipping test that requires a running server in CI environment";
     }
-    ElevatorController controller(1, 10);
+    ElevatorController controller(1, 10, 0, std::make_unique<NullEventSink>());
     controller.start();
     
     // Add a request to go to floor 10
@@ -93,4 +96,179 @@ TEST_F(ControllerTest, EmergencyStop) {
     EXPECT_EQ(status, ElevatorStatus::IDLE);
     
     controller.stop();
-} 
\ No newline at end of file
+}
+
+TEST_F(ControllerTest, DispatchesOnlyToCarsServingBothFloors) {
+    if (std::getenv("CI") != nullptr) {
+        GTEST_SKIP() << "Skipping test that requires a running server in CI environment";
+    }
+    ElevatorController controller(2, 20, 0, std::make_unique<NullEventSink>());
+    
+    // Car 0 serves the low zone, car 1 the lobby and high zone
+    ASSERT_TRUE(controller.setServedFloors(0, *parseBitList("1-10", 1, 20)));
+    ASSERT_TRUE(controller.setServedFloors(1, *parseBitList("1,11-20", 1, 20)));
+    EXPECT_FALSE(controller.setServedFloors(5, *parseBitList("1-10", 1, 20)));
+    controller.start();
+    
+    // No single car links floor 5 and floor 15
+    EXPECT_FALSE(controller.addRequest(5, 15, Direction::UP));
+    
+    // Both cars idle at the lobby; only car 1 may take this trip
+    EXPECT_TRUE(controller.addRequest(1, 15, Direction::UP));
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    
+    auto statuses = controller.getElevatorStatuses();
+    EXPECT_EQ(std::get<3>(statuses[0]), Direction::IDLE);
+    EXPECT_EQ(std::get<3>(statuses[1]), Direction::UP);
+    
+    controller.stop();
+}
+
+TEST_F(ControllerTest, BypassesFullCars) {
+    if (std::getenv("CI") != nullptr) {
+        GTEST_SKIP() << "Skipping test that requires a running server in CI environment";
+    }
+    ElevatorController controller(1, 10, 0, std::make_unique<NullEventSink>());
+    ASSERT_TRUE(controller.setCapacity(-1, 2));
+    controller.start();
+    
+    // Fill the only car, then call from a floor it passes on the way
+    EXPECT_TRUE(controller.addRequest(1, 5, Direction::UP, 2));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_TRUE(controller.addRequest(3, 4, Direction::UP));
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    
+    // The full car is skipped, so the call waits at the dispatcher
+    std::vector<ElevatorMetrics> metrics;
+    controller.getElevatorMetrics(metrics);
+    EXPECT_EQ(metrics[0].load, 2);
+    EXPECT_EQ(metrics[0].queueDepth, 0);
+    EXPECT_EQ(controller.getPendingRequestCount(), 1);
+    
+    controller.stop();
+}
+
+TEST_F(ControllerTest, DestinationDispatchGroupsCommonTrips) {
+    if (std::getenv("CI") != nullptr) {
+        GTEST_SKIP() << "Skipping test that requires a running server in CI environment";
+    }
+    ElevatorController controller(2, 10, 0, std::make_unique<NullEventSink>());
+    controller.setDispatchMode(DispatchMode::DESTINATION);
+    controller.start();
+    
+    EXPECT_FALSE(controller.addDestinationCall(3, 3).has_value());
+    
+    auto first = controller.addDestinationCall(1, 10, 2);
+    ASSERT_TRUE(first.has_value());
+    
+    // Keyed in while the first group is still boarding: same car
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    auto second = controller.addDestinationCall(1, 10, 3);
+    EXPECT_EQ(second, first);
+    EXPECT_EQ(controller.getGroupedRequestCount(), 1u);
+    
+    // A different destination gets its own car
+    auto third = controller.addDestinationCall(1, 5);
+    ASSERT_TRUE(third.has_value());
+    EXPECT_NE(*third, *first);
+    
+    // Doors close after the boarding hold with the whole group on board
+    std::this_thread::sleep_for(std::chrono::milliseconds(1200));
+    std::vector<ElevatorMetrics> metrics;
+    controller.getElevatorMetrics(metrics);
+    EXPECT_EQ(metrics[*first].load, 5);
+    
+    controller.stop();
+}
+
+TEST_F(ControllerTest, ReassignsCallsQueuedOnAStoppedCar) {
+    // Car 0 was stopped with two calls queued; car 1 is idle at the lobby
+    ControllerSnapshot snapshot;
+    snapshot.floors = 10;
+    snapshot.cars.push_back(CarSnapshot{0, 1, true, {Request(5, 0, Direction::UP), Request(8, 0, Direction::DOWN)}});
+    snapshot.cars.push_back(CarSnapshot{1, 1, false, {}});
+    
+    ElevatorController pinned(2, 10, 0, std::make_unique<NullEventSink>());
+    pinned.setCallReassignment(false);
+    ASSERT_TRUE(pinned.restore(snapshot));
+    pinned.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+    EXPECT_EQ(pinned.getReassignedRequestCount(), 0u);
+    EXPECT_EQ(pinned.snapshot().cars[0].requests.size(), 2u);
+    pinned.stop();
+    
+    ElevatorController controller(2, 10, 0, std::make_unique<NullEventSink>());
+    ASSERT_TRUE(controller.restore(snapshot));
+    controller.start();
+    
+    // One call leaves a car per pass, and passes run once a second
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(4);
+    while (controller.getReassignedRequestCount() < 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    EXPECT_EQ(controller.getReassignedRequestCount(), 2u);
+    EXPECT_TRUE(controller.snapshot().cars[0].requests.empty());
+    
+    controller.stop();
+}
+
+TEST_F(ControllerTest, ParksIdleCarWhereCallsAreExpected) {
+    ElevatorController controller(1, 10, 0, std::make_unique<NullEventSink>());
+    KinematicConfig fast;
+    fast.timeScale = 50.0;
+    ASSERT_TRUE(controller.setKinematics(fast));
+    controller.setParkingPolicy(true);
+    controller.start();
+    
+    // The trip ends at floor 9, but the only call so far came from floor 2
+    EXPECT_TRUE(controller.addRequest(2, 9, Direction::UP));
+    
+    auto parkedAtPickup = [&controller] {
+        auto statuses = controller.getElevatorStatuses();
+        return controller.getParkingMoveCount() > 0 && std::get<1>(statuses[0]) == 2 &&
+               std::get<4>(statuses[0]) == ElevatorStatus::IDLE;
+    };
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!parkedAtPickup() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    EXPECT_TRUE(parkedAtPickup());
+    
+    // Parking runs keep the doors shut and do not count as trips
+    std::vector<ElevatorMetrics> metrics;
+    controller.getElevatorMetrics(metrics);
+    EXPECT_EQ(metrics[0].trips, 2u);
+    
+    controller.stop();
+}
+
+TEST_F(ControllerTest, AdoptsDatabaseCarWhileDispatching) {
+    // Another instance of the building has written car 7, parked at floor 4
+    auto sink = std::make_unique<MemoryEventSink>();
+    sink->syncElevatorState(7, 4, 4, static_cast<int>(Direction::IDLE), static_cast<int>(ElevatorStatus::IDLE));
+    
+    ElevatorController controller(2, 10, 0, std::move(sink));
+    controller.start();
+    
+    // Dispatch and status readers keep walking the cars while the sync thread adopts
+    std::atomic<bool> reading{true};
+    std::thread reader([&] {
+        std::vector<ElevatorStatusRow> statuses;
+        for (int i = 0; reading; i++) {
+            controller.addRequest(i % 9 + 1, 10, Direction::UP);
+            controller.getElevatorStatuses(statuses);
+        }
+    });
+    
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(4);
+    while (controller.getNumElevators() < 3 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    reading = false;
+    reader.join();
+    
+    ASSERT_EQ(controller.getNumElevators(), 3);
+    EXPECT_TRUE(controller.hasElevator(7));
+    
+    controller.stop();
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "DatabaseLogger.h"
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+TEST(DatabaseLoggerTest, BuffersEventsUntilConnected) {
+    DatabaseLogger logger(false);
+    
+    logger.logSystemEvent(LogEventType::SYSTEM_STARTED);
+    logger.logEvent(LogEventType::CALL_REQUEST, -1, 3, 7);
+    EXPECT_FALSE(logger.isConnected());
+    EXPECT_EQ(logger.getBufferedEventCount(), 2u);
+    
+    // The background connection drains the buffer once it succeeds
+    logger.connectAsync();
+    for (int i = 0; i < 100 && !logger.isConnected(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(logger.isConnected());
+    EXPECT_EQ(logger.getBufferedEventCount(), 0u);
+    
+    logger.logEvent(LogEventType::CALL_REQUEST, -1, 7, 3);
+    EXPECT_EQ(logger.getBufferedEventCount(), 0u);
+}
+
+TEST(DatabaseLoggerTest, DropsOldestEventsWhenBufferIsFull) {
+    DatabaseLogger logger(false);
+    
+    for (size_t i = 0; i < DatabaseLogger::MAX_BUFFERED_EVENTS + 5; i++) {
+        logger.logEvent(LogEventType::CALL_REQUEST, -1, 1, 2);
+    }
+    
+    EXPECT_EQ(logger.getBufferedEventCount(), DatabaseLogger::MAX_BUFFERED_EVENTS);
+    EXPECT_EQ(logger.getEventCounters().dropped, 5u);
+}
+
+TEST(DatabaseLoggerTest, SpillsToDiskAndReplaysAfterRestart) {
+    std::string spillPath = ::testing::TempDir() + "elevator_spill_test.log";
+    std::remove(spillPath.c_str());
+    
+    {
+        DatabaseLogger logger(false);
+        logger.setSpillFile(spillPath);
+        for (size_t i = 0; i < DatabaseLogger::MAX_BUFFERED_EVENTS + 3; i++) {
+            logger.logEvent(LogEventType::CALL_REQUEST, -1, 1, 2);
+        }
+        
+        auto counters = logger.getEventCounters();
+        EXPECT_EQ(counters.spilled, DatabaseLogger::MAX_BUFFERED_EVENTS + 3);
+        EXPECT_EQ(counters.dropped, 0u);
+        EXPECT_EQ(logger.getBufferedEventCount(), DatabaseLogger::MAX_BUFFERED_EVENTS + 3);
+        
+        // Shutting down keeps the in-memory tail on disk as well
+        logger.disconnect();
+    }
+    
+    DatabaseLogger restarted(false);
+    restarted.setSpillFile(spillPath);
+    EXPECT_EQ(restarted.getBufferedEventCount(), DatabaseLogger::MAX_BUFFERED_EVENTS + 3);
+    
+    ASSERT_TRUE(restarted.connect());
+    EXPECT_EQ(restarted.getEventCounters().replayed, DatabaseLogger::MAX_BUFFERED_EVENTS + 3);
+    EXPECT_EQ(restarted.getBufferedEventCount(), 0u);
+    EXPECT_FALSE(std::ifstream(spillPath).good());
+}
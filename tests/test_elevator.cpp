@@ -83,6 +83,33 @@ TEST_F(ElevatorTest, EmergencyStop) {
     elevator.stop();
 }
 
+TEST_F(ElevatorTest, EmergencyAndStopInterruptARun) {
+    Elevator elevator(1, 1, 10);
+    KinematicConfig slow;
+    slow.timeScale = 0.1;
+    ASSERT_TRUE(elevator.setKinematics(slow, slow.buildTable(10)));
+    elevator.start();
+    
+    // Each floor of this run takes several seconds of wall time
+    elevator.addRequest(Request(1, 10, Direction::UP));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(elevator.getStatus(), ElevatorStatus::MOVING);
+    
+    // The car halts between floors rather than finishing the leg
+    elevator.emergencyStopActivate();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    EXPECT_EQ(elevator.getCurrentFloor(), 1);
+    EXPECT_EQ(elevator.getStatus(), ElevatorStatus::EMERGENCY);
+    
+    elevator.emergencyStopRelease();
+    elevator.addRequest(Request(1, 10, Direction::UP));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    
+    auto stopStart = std::chrono::steady_clock::now();
+    elevator.stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - stopStart, std::chrono::milliseconds(500));
+}
+
 TEST_F(ElevatorTest, CalculateDistance) {
     Elevator elevator(1, 5);
     
@@ -91,4 +118,69 @@ TEST_F(ElevatorTest, CalculateDistance) {
     
     // Distance from floor 5 to 2
     EXPECT_EQ(elevator.calculateDistance(2), 3);
-}
\ No newline at end of file
+}
+
+TEST_F(ElevatorTest, ServedFloors) {
+    Elevator elevator(1, 1, 40);
+    
+    // Express car: lobby plus the upper zone
+    auto floors = parseBitList("1,21-40", 1, 40);
+    ASSERT_TRUE(floors.has_value());
+    EXPECT_TRUE(elevator.setServedFloors(*floors));
+    
+    EXPECT_TRUE(elevator.servesFloor(1));
+    EXPECT_FALSE(elevator.servesFloor(10));
+    EXPECT_TRUE(elevator.servesFloor(30));
+    EXPECT_FALSE(elevator.servesFloor(41));
+    
+    // Requests touching an unserved floor are rejected
+    EXPECT_FALSE(elevator.addRequest(Request(1, 10, Direction::UP)));
+    EXPECT_TRUE(elevator.addRequest(Request(1, 30, Direction::UP)));
+    
+    // A car that does not serve its start floor starts at its lowest served floor
+    Elevator upperZone(2, 1, 40);
+    EXPECT_TRUE(upperZone.setServedFloors(*parseBitList("21-40", 1, 40)));
+    EXPECT_EQ(upperZone.getCurrentFloor(), 21);
+    
+    // Masks for a different building height are refused
+    EXPECT_FALSE(upperZone.setServedFloors(*parseBitList("1-5", 1, 10)));
+}
+
+TEST_F(ElevatorTest, BoardsUpToCapacity) {
+    Elevator elevator(1, 1, 10);
+    ASSERT_TRUE(elevator.setCapacity(2));
+    elevator.start();
+    
+    // Three passengers at the car's floor: two board, one waits for the next visit
+    EXPECT_TRUE(elevator.addRequest(Request(1, 2, Direction::UP, 3)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    
+    EXPECT_EQ(elevator.getLoad(), 2);
+    EXPECT_EQ(elevator.getQueueDepth(), 1);
+    EXPECT_EQ(elevator.getAvailableCapacity(), -1);
+    
+    // One floor of travel plus the door cycle
+    std::this_thread::sleep_for(std::chrono::milliseconds(3500));
+    EXPECT_EQ(elevator.getPassengersDelivered(), 2);
+    EXPECT_EQ(elevator.getRecentDeliveries(), 2);
+    
+    elevator.stop();
+}
+
+TEST_F(ElevatorTest, EtaIncludesCommittedTrips) {
+    Elevator elevator(1, 1, 20);
+    const TravelTimeTable& table = elevator.getTravelTimes();
+    const DoorTiming& doors = elevator.getDoorTiming();
+    
+    // An idle car goes straight there
+    EXPECT_EQ(elevator.estimateTravelTime(7), table.travelTime(1, 7));
+    
+    // A busy car first serves its queue in order: 1 -> 10, then 10 -> 2
+    EXPECT_TRUE(elevator.addRequest(Request(1, 10, Direction::UP)));
+    EXPECT_TRUE(elevator.addRequest(Request(10, 2, Direction::DOWN, 3)));
+    
+    auto committed = table.travelTime(1, 10) + doors.stopTime(1) +
+                     table.travelTime(10, 2) + doors.stopTime(3);
+    EXPECT_EQ(elevator.estimateTravelTime(5), committed + table.travelTime(2, 5));
+    EXPECT_EQ(elevator.estimateTravelTime(2), committed);
+}
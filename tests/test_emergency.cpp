@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "ElevatorController.h"
+#include "EventSink.h"
 #include <thread>
 #include <chrono>
 
@@ -15,7 +16,7 @@ protected:
 };
 
 TEST_F(EmergencyTest, EmergencyStopAllElevators) {
-    ElevatorController controller(3, 10);
+    ElevatorController controller(3, 10, 0, std::make_unique<NullEventSink>());
     controller.start();
     
     // Add requests to all elevators
@@ -44,7 +45,7 @@ TEST_F(EmergencyTest, EmergencyStopAllElevators) {
 
 TEST_F(EmergencyTest, NoRequestsDuringEmergency) {
     // Create controller with 1 elevator and 10 floors
-    ElevatorController controller(1, 10);
+    ElevatorController controller(1, 10, 0, std::make_unique<NullEventSink>());
     
     // Start the controller
     controller.start();
@@ -80,4 +81,29 @@ TEST_F(EmergencyTest, NoRequestsDuringEmergency) {
     
     // Wait for controller to stop
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
-} 
\ No newline at end of file
+}
+
+TEST_F(EmergencyTest, ReleaseResumesQueuedTrips) {
+    Elevator elevator(0, 1, 10);
+    KinematicConfig fast;
+    fast.timeScale = 50.0;
+    ASSERT_TRUE(elevator.setKinematics(fast, fast.buildTable(10)));
+    
+    // A trip queued during an emergency waits for the release, not for another request
+    ASSERT_TRUE(elevator.restore(1, true, {Request(1, 4, Direction::UP)}));
+    elevator.start();
+    
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(elevator.getStatus(), ElevatorStatus::EMERGENCY);
+    EXPECT_EQ(elevator.getCurrentFloor(), 1);
+    
+    elevator.emergencyStopRelease();
+    
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (elevator.getCurrentFloor() != 4 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(elevator.getCurrentFloor(), 4);
+    
+    elevator.stop();
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include "ElevatorController.h"
+#include "EventBus.h"
+#include "EventSink.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+TEST(EventBusTest, SubscribersSeeOnlyTheirTypes) {
+    EventBus bus;
+    auto all = bus.subscribe();
+    auto doors = bus.subscribe(EventBus::typeBit(LogEventType::DOOR_OPENED) |
+                               EventBus::typeBit(LogEventType::DOOR_CLOSED));
+    
+    bus.publish(LogEventType::ELEVATOR_DEPARTED, 1, 1, 4);
+    bus.publish(LogEventType::DOOR_OPENED, 1, 4, 4);
+    bus.publish(LogEventType::DOOR_CLOSED, 1, 4, 4);
+    
+    EventRecord event;
+    int seen = 0;
+    while (all->poll(event)) {
+        seen++;
+    }
+    EXPECT_EQ(seen, 3);
+    
+    ASSERT_TRUE(doors->poll(event));
+    EXPECT_EQ(event.type, LogEventType::DOOR_OPENED);
+    EXPECT_EQ(event.fromFloor, 4);
+    ASSERT_TRUE(doors->poll(event));
+    EXPECT_EQ(event.type, LogEventType::DOOR_CLOSED);
+    EXPECT_FALSE(doors->poll(event));
+    
+    // History and counters see every event, subscribed or not
+    std::vector<EventRecord> recent;
+    EXPECT_EQ(bus.getRecent(recent, 10), 3u);
+    EXPECT_EQ(recent[0].type, LogEventType::DOOR_CLOSED);
+    EXPECT_EQ(bus.getPublishedCount(LogEventType::ELEVATOR_DEPARTED), 1u);
+    
+    // Unsubscribed queues receive nothing more
+    bus.unsubscribe(all);
+    bus.publish(LogEventType::FLOOR_PASSED, 1, 2, 3);
+    EXPECT_FALSE(all->poll(event));
+}
+
+TEST(EventBusTest, FullQueueDropsAndCounts) {
+    EventBus bus;
+    auto slow = bus.subscribe(EventBus::ALL_EVENTS, 4);
+    
+    for (int i = 0; i < 6; i++) {
+        bus.publish(LogEventType::FLOOR_PASSED, 0, i, i + 1);
+    }
+    
+    EXPECT_EQ(slow->getDropped(), 2u);
+    EXPECT_EQ(bus.getDroppedCount(), 2u);
+    
+    // The oldest events are kept, in order
+    EventRecord event;
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(slow->poll(event));
+        EXPECT_EQ(event.fromFloor, i);
+    }
+    EXPECT_FALSE(slow->poll(event));
+    
+    // Drops of a departed subscriber still count
+    bus.unsubscribe(slow);
+    EXPECT_EQ(bus.getDroppedCount(), 2u);
+}
+
+TEST(EventBusTest, SubscribersComeAndGoWhilePublishing) {
+    EventBus bus;
+    auto steady = bus.subscribe(EventBus::ALL_EVENTS, 1 << 16);
+    std::atomic<bool> publishing{true};
+    
+    std::vector<std::thread> publishers;
+    for (int i = 0; i < 4; i++) {
+        publishers.emplace_back([&bus, &publishing, i] {
+            while (publishing.load()) {
+                bus.publish(LogEventType::FLOOR_PASSED, i, 1, 2);
+            }
+        });
+    }
+    
+    // Every swap frees the list the publishers were iterating
+    for (int i = 0; i < 200; i++) {
+        auto transient = bus.subscribe(EventBus::ALL_EVENTS, 4);
+        bus.unsubscribe(transient);
+    }
+    publishing.store(false);
+    for (auto& publisher : publishers) {
+        publisher.join();
+    }
+    
+    EventRecord event;
+    EXPECT_TRUE(steady->poll(event));
+}
+
+TEST(EventBusTest, WaitForWakesOnPublish) {
+    EventBus bus;
+    auto subscription = bus.subscribe();
+    
+    std::thread publisher([&bus] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        bus.publish(LogEventType::CALL_REQUEST, -1, 2, 5);
+    });
+    
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(subscription->waitFor(std::chrono::seconds(5)));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+    publisher.join();
+    
+    EventRecord event;
+    ASSERT_TRUE(subscription->poll(event));
+    EXPECT_EQ(event.toFloor, 5);
+    
+    // An empty queue times out unless woken
+    EXPECT_FALSE(subscription->waitFor(std::chrono::milliseconds(10)));
+}
+
+TEST(EventBusTest, CarPublishesMotionAndDoorEvents) {
+    ElevatorController controller(1, 5, 0, std::make_unique<NullEventSink>());
+    KinematicConfig fast;
+    fast.timeScale = 50.0;
+    ASSERT_TRUE(controller.setKinematics(fast));
+    
+    auto events = controller.getEventBus().subscribe();
+    controller.start();
+    controller.addRequest(3, 0, Direction::UP);
+    
+    std::vector<LogEventType> seen;
+    EventRecord event;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (std::chrono::steady_clock::now() < deadline &&
+           (seen.empty() || seen.back() != LogEventType::DOOR_CLOSED)) {
+        events->waitFor(std::chrono::milliseconds(100));
+        while (events->poll(event)) {
+            // The dispatcher's own events for this car may land mid-run
+            if (event.elevatorId == 0 && event.type != LogEventType::ELEVATOR_DISPATCHED) {
+                seen.push_back(event.type);
+            }
+        }
+    }
+    controller.stop();
+    controller.getEventBus().unsubscribe(events);
+    
+    // Floor 1 to 3: depart, pass floor 2, arrive, then the door cycle
+    std::vector<LogEventType> expected = {
+        LogEventType::ELEVATOR_DEPARTED, LogEventType::FLOOR_PASSED, LogEventType::ELEVATOR_ARRIVED,
+        LogEventType::DOOR_OPENED, LogEventType::DOOR_CLOSED};
+    auto first = std::find(seen.begin(), seen.end(), LogEventType::ELEVATOR_DEPARTED);
+    ASSERT_NE(first, seen.end());
+    EXPECT_EQ(std::vector<LogEventType>(first, seen.end()), expected);
+}
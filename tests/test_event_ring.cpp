@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include "EventRing.h"
+#include <thread>
+#include <vector>
+
+TEST(EventRingTest, CapacityRoundsUpToPowerOfTwo) {
+    EventRing ring(100);
+    
+    EXPECT_EQ(ring.getCapacity(), 128);
+    EXPECT_EQ(ring.getTotalPushed(), 0);
+}
+
+TEST(EventRingTest, SnapshotIsNewestFirst) {
+    EventRing ring(8);
+    
+    ring.push(LogEventType::CALL_REQUEST, 0, 1, 5);
+    ring.push(LogEventType::ELEVATOR_DISPATCHED, 2, 1, 5);
+    ring.push(LogEventType::EMERGENCY_STOP, -1, -1, -1);
+    
+    std::vector<EventRecord> events;
+    EXPECT_EQ(ring.snapshot(events, 10), 3);
+    
+    EXPECT_EQ(events[0].type, LogEventType::EMERGENCY_STOP);
+    EXPECT_EQ(events[1].type, LogEventType::ELEVATOR_DISPATCHED);
+    EXPECT_EQ(events[1].elevatorId, 2);
+    EXPECT_EQ(events[2].type, LogEventType::CALL_REQUEST);
+    EXPECT_EQ(events[2].toFloor, 5);
+    
+    // Limit returns only the newest entries
+    EXPECT_EQ(ring.snapshot(events, 1), 1);
+    EXPECT_EQ(events[0].type, LogEventType::EMERGENCY_STOP);
+}
+
+TEST(EventRingTest, OverwritesOldestWhenFull) {
+    EventRing ring(4);
+    
+    for (int i = 0; i < 10; i++) {
+        ring.push(LogEventType::CALL_REQUEST, 0, i, 0);
+    }
+    
+    std::vector<EventRecord> events;
+    EXPECT_EQ(ring.snapshot(events, 10), 4);
+    EXPECT_EQ(ring.getTotalPushed(), 10);
+    
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(events[i].fromFloor, 9 - i);
+    }
+}
+
+TEST(EventRingTest, ConcurrentWriters) {
+    EventRing ring(64);
+    const int numThreads = 4;
+    const int perThread = 1000;
+    
+    std::vector<std::thread> writers;
+    for (int t = 0; t < numThreads; t++) {
+        writers.emplace_back([&ring, t, perThread]() {
+            for (int i = 0; i < perThread; i++) {
+                ring.push(LogEventType::SYNC_EVENT, t, i, i);
+            }
+        });
+    }
+    
+    // Read concurrently; every record seen must be internally consistent
+    std::vector<EventRecord> events;
+    for (int i = 0; i < 100; i++) {
+        ring.snapshot(events, 64);
+        for (const auto& event : events) {
+            EXPECT_EQ(event.fromFloor, event.toFloor);
+        }
+    }
+    
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    
+    EXPECT_EQ(ring.getTotalPushed(), static_cast<uint64_t>(numThreads * perThread));
+    EXPECT_EQ(ring.snapshot(events, 64), 64);
+}
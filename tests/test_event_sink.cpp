@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include "ElevatorController.h"
+#include "EventSink.h"
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+TEST(EventSinkTest, ControllerLogsToInjectedSink) {
+    auto sink = std::make_unique<MemoryEventSink>();
+    MemoryEventSink* events = sink.get();
+    
+    ElevatorController controller(2, 10, 0, std::move(sink));
+    controller.start();
+    controller.addRequest(3, 7, Direction::UP);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    controller.stop();
+    
+    auto recorded = events->getEvents();
+    ASSERT_GE(recorded.size(), 3u);
+    EXPECT_EQ(recorded.front().eventType, LogEventType::SYSTEM_STARTED);
+    EXPECT_EQ(recorded.back().eventType, LogEventType::SYSTEM_STOPPED);
+    
+    bool sawCall = false;
+    for (const auto& event : recorded) {
+        sawCall = sawCall || (event.eventType == LogEventType::CALL_REQUEST && event.fromFloor == 3);
+    }
+    EXPECT_TRUE(sawCall);
+    
+    // History queries go through the sink, newest first
+    auto logs = controller.getLoggedEvents(1);
+    ASSERT_EQ(logs.size(), 1u);
+    EXPECT_EQ(std::get<1>(logs[0]), "SYSTEM_STOPPED");
+}
+
+TEST(EventSinkTest, EventsLostBeforeTheSinkCountAsDropped) {
+    auto sink = std::make_unique<MemoryEventSink>();
+    MemoryEventSink* events = sink.get();
+    ElevatorController controller(1, 10, 0, std::move(sink));
+    
+    // The sink thread only drains after start(), so the queue fills
+    const int published = 10000;
+    for (int i = 0; i < published; i++) {
+        controller.getEventBus().publish(LogEventType::CALL_REQUEST, -1, 1, 2);
+    }
+    controller.start();
+    controller.stop();
+    
+    size_t reached = 0;
+    for (const auto& event : events->getEvents()) {
+        reached += event.eventType == LogEventType::CALL_REQUEST;
+    }
+    EXPECT_LT(reached, static_cast<size_t>(published));
+    EXPECT_EQ(controller.getDatabaseEventCounters().dropped, published - reached);
+}
+
+TEST(EventSinkTest, MemorySinkIsBounded) {
+    MemoryEventSink sink(2);
+    sink.logEvent(LogEventType::CALL_REQUEST, -1, 1, 2);
+    sink.logEvent(LogEventType::CALL_REQUEST, -1, 2, 3);
+    sink.logEvent(LogEventType::CALL_REQUEST, -1, 3, 4);
+    
+    auto events = sink.getEvents();
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events.front().fromFloor, 2);
+}
+
+TEST(EventSinkTest, JournalAppendsAndReadsBack) {
+    std::string path = ::testing::TempDir() + "elevator_journal_test.log";
+    std::remove(path.c_str());
+    
+    JournalEventSink journal(path);
+    journal.open();
+    ASSERT_TRUE(journal.isConnected());
+    journal.logEvent(LogEventType::CALL_REQUEST, -1, 3, 7);
+    journal.logEvent(LogEventType::ELEVATOR_DISPATCHED, 1, 3, 7);
+    journal.close();
+    
+    auto logs = journal.getRecentLogs(10);
+    ASSERT_EQ(logs.size(), 2u);
+    EXPECT_EQ(std::get<1>(logs[0]), "ELEVATOR_DISPATCHED");
+    EXPECT_EQ(std::get<2>(logs[0]), 1);
+    EXPECT_EQ(std::get<3>(logs[1]), 3);
+    
+    std::remove(path.c_str());
+}
+
+TEST(EventSinkTest, HistoryContinuesBeforeTheOldestRingRecord) {
+    // Drops everything while down, like a database that is unreachable
+    class OutageSink : public MemoryEventSink {
+    public:
+        std::atomic<bool> down{false};
+        std::atomic<int> lost{0};
+        
+        void logEvent(LogEventType eventType, int elevatorId, int fromFloor, int toFloor) override {
+            if (down) {
+                lost++;
+                return;
+            }
+            MemoryEventSink::logEvent(eventType, elevatorId, fromFloor, toFloor);
+        }
+    };
+    
+    auto sink = std::make_unique<OutageSink>();
+    OutageSink* outage = sink.get();
+    
+    // History from before this run, only in the database
+    outage->logEvent(LogEventType::CALL_REQUEST, -1, 1, 2);
+    outage->logEvent(LogEventType::CALL_REQUEST, -1, 2, 3);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    
+    ElevatorController controller(1, 10, 0, std::move(sink));
+    controller.start();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (outage->getEvents().size() < 3 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_EQ(outage->getEvents().size(), 3u);  // SYSTEM_STARTED
+    
+    // Floors passed reach only the ring; two calls are lost to the outage
+    for (int floor = 2; floor <= 5; floor++) {
+        controller.getEventBus().publish(LogEventType::FLOOR_PASSED, 0, floor - 1, floor);
+    }
+    outage->down = true;
+    controller.getEventBus().publish(LogEventType::CALL_REQUEST, -1, 4, 8);
+    controller.getEventBus().publish(LogEventType::CALL_REQUEST, -1, 5, 9);
+    deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (outage->lost < 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_EQ(outage->lost, 2);
+    outage->down = false;
+    
+    auto events = controller.getRecentEvents(20);
+    ASSERT_FALSE(events.empty());
+    ASSERT_LT(events.size(), 20u);
+    auto oldest = std::chrono::system_clock::time_point(std::chrono::milliseconds(events.back().timestampMs));
+    
+    // Exactly the rows older than the ring: nothing it shows again, nothing skipped
+    auto logs = controller.getLoggedEvents(20 - static_cast<int>(events.size()), oldest);
+    ASSERT_EQ(logs.size(), 2u);
+    EXPECT_EQ(std::get<3>(logs[0]), 2);
+    EXPECT_EQ(std::get<3>(logs[1]), 1);
+    
+    controller.stop();
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include "Kinematics.h"
+#include "ElevatorController.h"
+#include "EventSink.h"
+#include <cmath>
+
+TEST(KinematicsTest, ClosedFormProfileRegimes) {
+    MotionProfile profile;  // 2.5 m/s, 1.0 m/s^2, 1.5 m/s^3
+    
+    EXPECT_DOUBLE_EQ(travelTimeSeconds(profile, 0.0), 0.0);
+    
+    // Long run: cruises at top speed after a ramp of v/a + a/j
+    double ramp = 2.5 / 1.0 + 1.0 / 1.5;
+    EXPECT_NEAR(travelTimeSeconds(profile, 100.0), 100.0 / 2.5 + ramp, 1e-9);
+    
+    // Very short run never reaches full acceleration: 4 * cbrt(d / 2j)
+    EXPECT_NEAR(travelTimeSeconds(profile, 0.1), 4.0 * std::cbrt(0.1 / 3.0), 1e-9);
+    
+    // Travel time grows with distance across the regime boundaries
+    double previous = 0.0;
+    for (double distance = 0.05; distance < 40.0; distance += 0.05) {
+        double time = travelTimeSeconds(profile, distance);
+        EXPECT_GT(time, previous);
+        previous = time;
+    }
+}
+
+TEST(KinematicsTest, TableUsesStoreyHeights) {
+    // 5 m lobby storey, then 3 m storeys
+    TravelTimeTable table(5, MotionProfile(), {5.0, 3.0});
+    
+    EXPECT_DOUBLE_EQ(table.floorPosition(1), 0.0);
+    EXPECT_DOUBLE_EQ(table.floorPosition(2), 5.0);
+    EXPECT_DOUBLE_EQ(table.floorPosition(5), 14.0);
+    
+    EXPECT_EQ(table.travelTime(3, 3).count(), 0);
+    EXPECT_EQ(table.travelTime(1, 5), table.travelTime(5, 1));
+    EXPECT_GT(table.travelTime(1, 2), table.travelTime(2, 3));
+    EXPECT_EQ(table.travelTime(1, 5).count(), std::lround(travelTimeSeconds(MotionProfile(), 14.0) * 1000.0));
+}
+
+TEST(KinematicsTest, DoorsStayOpenLongerForMorePassengers) {
+    DoorTiming doors;
+    
+    EXPECT_EQ(doors.stopTime(0).count(), doors.openMs + doors.minDwellMs + doors.closeMs);
+    EXPECT_GT(doors.stopTime(6), doors.stopTime(1));
+}
+
+TEST(KinematicsTest, ControllerSharesTableAcrossCars) {
+    ElevatorController controller(2, 20, 0, std::make_unique<NullEventSink>());
+    
+    KinematicConfig config;
+    config.motion.maxSpeed = 6.0;
+    EXPECT_TRUE(controller.setKinematics(config));
+    EXPECT_EQ(controller.getTravelTimes().getNumFloors(), 20);
+    EXPECT_EQ(controller.getTravelTimes().travelTime(1, 20).count(),
+              std::lround(travelTimeSeconds(config.motion, 19 * TravelTimeTable::DEFAULT_FLOOR_HEIGHT) * 1000.0));
+    
+    config.timeScale = 0.0;
+    EXPECT_FALSE(controller.setKinematics(config));
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include "Metrics.h"
+#include "ProfiledMutex.h"
+#include <thread>
+#include <vector>
+
+TEST(MetricsTest, RecordsIntoMatchingBucket) {
+    LatencyHistogram histogram;
+    
+    histogram.record(std::chrono::microseconds(10));   // <= 50us
+    histogram.record(std::chrono::microseconds(50));   // <= 50us (bounds are inclusive)
+    histogram.record(std::chrono::milliseconds(3));    // <= 5ms
+    histogram.record(std::chrono::seconds(10));        // +Inf
+    
+    auto snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count, 4);
+    EXPECT_EQ(snapshot.buckets[0], 2);
+    EXPECT_EQ(snapshot.buckets[6], 1);
+    EXPECT_EQ(snapshot.buckets[LatencyHistogram::NUM_BUCKETS - 1], 1);
+    EXPECT_EQ(snapshot.sumNanos, 10000 + 50000 + 3000000 + 10000000000ULL);
+}
+
+TEST(MetricsTest, AggregatesShardsFromAllThreads) {
+    LatencyHistogram histogram;
+    const int numThreads = 4;
+    const int perThread = 10000;
+    
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; t++) {
+        threads.emplace_back([&histogram, perThread]() {
+            for (int i = 0; i < perThread; i++) {
+                histogram.record(std::chrono::microseconds(200));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    auto snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count, static_cast<uint64_t>(numThreads * perThread));
+    EXPECT_EQ(snapshot.buckets[2], static_cast<uint64_t>(numThreads * perThread));
+}
+
+TEST(MetricsTest, HistogramsDoNotShareShards) {
+    // A thread recording into two histograms must keep their counts separate
+    LatencyHistogram first;
+    LatencyHistogram second;
+    
+    first.record(std::chrono::microseconds(1));
+    second.record(std::chrono::microseconds(1));
+    second.record(std::chrono::microseconds(1));
+    
+    EXPECT_EQ(first.snapshot().count, 1);
+    EXPECT_EQ(second.snapshot().count, 2);
+}
+
+TEST(MetricsTest, ShortLivedHistogramsDoNotDisturbLongLivedOnes) {
+    // Every slot of this thread's shard cache is overwritten in between
+    LatencyHistogram longLived;
+    longLived.record(std::chrono::microseconds(1));
+    for (int i = 0; i < 200; i++) {
+        LatencyHistogram shortLived;
+        shortLived.record(std::chrono::microseconds(1));
+        EXPECT_EQ(shortLived.snapshot().count, 1u);
+    }
+    longLived.record(std::chrono::microseconds(1));
+    
+    EXPECT_EQ(longLived.snapshot().count, 2u);
+}
+
+TEST(MetricsTest, ApproximateQuantileReportsBucketUpperBound) {
+    LatencyHistogram histogram;
+    for (int i = 0; i < 99; i++) {
+        histogram.record(std::chrono::microseconds(20));
+    }
+    histogram.record(std::chrono::milliseconds(20));
+    
+    auto snapshot = histogram.snapshot();
+    EXPECT_EQ(approximateQuantileUs(snapshot, 0.5), 50u);
+    EXPECT_EQ(approximateQuantileUs(snapshot, 0.999), 25000u);
+    EXPECT_EQ(approximateQuantileUs(LatencyHistogram::Snapshot{}, 0.5), 0u);
+}
+
+TEST(MetricsTest, ProfiledMutexRecordsWaitAndHold) {
+    ProfiledMutex first("MetricsTest::sharedProfile");
+    ProfiledMutex second("MetricsTest::sharedProfile");
+    
+    {
+        std::lock_guard<ProfiledMutex> lock(first);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    
+    // Hold the lock long enough that the other thread has to wait for it
+    std::unique_lock<ProfiledMutex> held(second);
+    std::thread waiter([&second]() {
+        std::lock_guard<ProfiledMutex> lock(second);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    held.unlock();
+    waiter.join();
+    
+    ASSERT_TRUE(first.try_lock());
+    first.unlock();
+    
+    LockProfiler::LockReport found{};
+    for (const auto& entry : LockProfiler::instance().report()) {
+        if (entry.name == "MetricsTest::sharedProfile") {
+            found = entry;
+        }
+    }
+    
+    // Both mutexes report under the shared name
+    EXPECT_EQ(found.acquisitions, 4u);
+    EXPECT_EQ(found.hold.count, 4u);
+    EXPECT_EQ(found.contended, 1u);
+    EXPECT_GE(found.hold.sumNanos, 25000000u);
+    EXPECT_GE(found.wait.sumNanos, 10000000u);
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "ShardedController.h"
+#include "EventSink.h"
+#include <thread>
+#include <chrono>
+
+static std::unique_ptr<EventSink> nullSink(size_t) {
+    return std::make_unique<NullEventSink>();
+}
+
+TEST(ShardedControllerTest, ParsesShardSpec) {
+    auto configs = parseShardSpec("low:4:20,high:2:40");
+    ASSERT_TRUE(configs.has_value());
+    ASSERT_EQ(configs->size(), 2);
+    EXPECT_EQ((*configs)[0].name, "low");
+    EXPECT_EQ((*configs)[0].elevators, 4);
+    EXPECT_EQ((*configs)[0].floors, 20);
+    EXPECT_EQ((*configs)[1].name, "high");
+    EXPECT_EQ((*configs)[1].floors, 40);
+    
+    EXPECT_FALSE(parseShardSpec("").has_value());
+    EXPECT_FALSE(parseShardSpec("low:4").has_value());
+    EXPECT_FALSE(parseShardSpec(":4:20").has_value());
+    EXPECT_FALSE(parseShardSpec("low:0:20").has_value());
+    EXPECT_FALSE(parseShardSpec("low:4:1").has_value());
+    EXPECT_FALSE(parseShardSpec("low:4:20x").has_value());
+    EXPECT_FALSE(parseShardSpec("low:4:20,low:2:10").has_value());
+    
+    // Names are written unescaped into JSON and metrics labels
+    EXPECT_TRUE(parseShardSpec("tower-2_low:1:10").has_value());
+    EXPECT_FALSE(parseShardSpec("a\"b:1:10").has_value());
+    EXPECT_FALSE(parseShardSpec("a\\b:1:10").has_value());
+    EXPECT_FALSE(parseShardSpec("a\nb:1:10").has_value());
+    EXPECT_FALSE(parseShardSpec("a b:1:10").has_value());
+}
+
+TEST(ShardedControllerTest, NumbersCarsAcrossShards) {
+    ShardedController shards({{"a", 2, 10}, {"b", 3, 15}}, false, nullSink);
+    
+    ASSERT_EQ(shards.getShardCount(), 2);
+    EXPECT_EQ(shards.getTotalElevators(), 5);
+    EXPECT_EQ(shards.getShard(1).getNumFloors(), 15);
+    
+    std::vector<ElevatorStatusRow> rows;
+    shards.getShard(1).getElevatorStatuses(rows);
+    ASSERT_EQ(rows.size(), 3);
+    EXPECT_EQ(std::get<0>(rows[0]), 2);
+    EXPECT_EQ(std::get<0>(rows[2]), 4);
+    
+    EXPECT_EQ(shards.findShard("b"), std::optional<size_t>(1));
+    EXPECT_EQ(shards.findShard("0"), std::optional<size_t>(0));
+    EXPECT_FALSE(shards.findShard("2").has_value());
+    EXPECT_FALSE(shards.findShard("c").has_value());
+}
+
+TEST(ShardedControllerTest, RequestsStayInTheirShard) {
+    ShardedController shards({{"a", 1, 10}, {"b", 1, 10}}, false, nullSink);
+    shards.start();
+    
+    shards.getShard(1).addRequest(3, 0, Direction::UP);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    
+    std::vector<ElevatorStatusRow> rows;
+    shards.getShard(0).getElevatorStatuses(rows);
+    EXPECT_EQ(std::get<3>(rows[0]), Direction::IDLE);
+    
+    shards.getShard(1).getElevatorStatuses(rows);
+    EXPECT_EQ(std::get<3>(rows[0]), Direction::UP);
+    
+    shards.stop();
+}
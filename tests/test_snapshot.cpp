@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include "ElevatorController.h"
+#include "EventSink.h"
+#include "Snapshot.h"
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+class SnapshotTest : public ::testing::Test {
+protected:
+    std::string checkpointPath = ::testing::TempDir() + "elevator_snapshot_test.bin";
+    
+    void TearDown() override {
+        std::remove(checkpointPath.c_str());
+    }
+    
+    ControllerSnapshot sample() {
+        ControllerSnapshot snapshot;
+        snapshot.floors = 10;
+        snapshot.dispatchMode = DispatchMode::DESTINATION;
+        snapshot.cars.push_back(CarSnapshot{0, 4, false, {Request(4, 9, Direction::UP, 3), Request(2, 0, Direction::UP)}});
+        snapshot.cars.push_back(CarSnapshot{1, 7, true, {}});
+        snapshot.pending.push_back(Request(8, 1, Direction::DOWN, 2));
+        return snapshot;
+    }
+};
+
+TEST_F(SnapshotTest, EncodingRoundTrips) {
+    ControllerSnapshot original = sample();
+    std::string data = encodeSnapshot(original);
+    
+    auto decoded = decodeSnapshot(data);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->floors, 10);
+    EXPECT_EQ(decoded->dispatchMode, DispatchMode::DESTINATION);
+    ASSERT_EQ(decoded->cars.size(), 2u);
+    EXPECT_EQ(decoded->cars[0].floor, 4);
+    ASSERT_EQ(decoded->cars[0].requests.size(), 2u);
+    EXPECT_EQ(decoded->cars[0].requests[0].toFloor, 9);
+    EXPECT_EQ(decoded->cars[0].requests[0].passengers, 3);
+    EXPECT_EQ(decoded->cars[0].requests[1].passengers, 0);
+    EXPECT_TRUE(decoded->cars[1].emergency);
+    ASSERT_EQ(decoded->pending.size(), 1u);
+    EXPECT_EQ(decoded->pending[0].direction, Direction::DOWN);
+    EXPECT_EQ(std::chrono::duration_cast<std::chrono::milliseconds>(decoded->pending[0].timestamp.time_since_epoch()),
+              std::chrono::duration_cast<std::chrono::milliseconds>(original.pending[0].timestamp.time_since_epoch()));
+    
+    // Corrupt or truncated checkpoints are rejected rather than half-loaded
+    std::string corrupt = data;
+    corrupt[20] ^= 0x40;
+    EXPECT_FALSE(decodeSnapshot(corrupt).has_value());
+    EXPECT_FALSE(decodeSnapshot(std::string_view(data).substr(0, data.size() - 5)).has_value());
+    EXPECT_FALSE(decodeSnapshot("").has_value());
+}
+
+TEST_F(SnapshotTest, RestoresQueuesAndPendingCalls) {
+    ElevatorController controller(2, 10, 0, std::make_unique<NullEventSink>());
+    ASSERT_TRUE(controller.restore(sample()));
+    
+    EXPECT_EQ(controller.getDispatchMode(), DispatchMode::DESTINATION);
+    EXPECT_EQ(controller.getPendingRequestCount(), 1u);
+    
+    ControllerSnapshot restored = controller.snapshot();
+    ASSERT_EQ(restored.cars.size(), 2u);
+    EXPECT_EQ(restored.cars[0].floor, 4);
+    EXPECT_EQ(restored.cars[0].requests.size(), 2u);
+    EXPECT_TRUE(restored.cars[1].emergency);
+    
+    // A different building is refused
+    ElevatorController taller(2, 20, 0, std::make_unique<NullEventSink>());
+    EXPECT_FALSE(taller.restore(sample()));
+}
+
+TEST_F(SnapshotTest, CheckpointsOnStop) {
+    {
+        ElevatorController controller(1, 10, 0, std::make_unique<NullEventSink>());
+        controller.setCheckpointFile(checkpointPath, std::chrono::hours(1));
+        controller.start();
+        
+        // Calls made during an emergency wait in the pending queue
+        controller.emergencyStop();
+        controller.addRequest(3, 6, Direction::UP);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        controller.stop();
+    }
+    
+    auto snapshot = readSnapshotFile(checkpointPath);
+    ASSERT_TRUE(snapshot.has_value());
+    ASSERT_EQ(snapshot->cars.size(), 1u);
+    EXPECT_TRUE(snapshot->cars[0].emergency);
+    ASSERT_EQ(snapshot->pending.size(), 1u);
+    EXPECT_EQ(snapshot->pending[0].fromFloor, 3);
+    
+    ElevatorController restarted(1, 10, 0, std::make_unique<NullEventSink>());
+    ASSERT_TRUE(restarted.restore(*snapshot));
+    EXPECT_EQ(restarted.getPendingRequestCount(), 1u);
+}
+
+TEST_F(SnapshotTest, CheckpointSeesRequestsTheDispatcherIsHandling) {
+    ElevatorController controller(4, 20, 0, std::make_unique<NullEventSink>());
+    // Room for every call, so the dispatcher keeps handing them to cars
+    ASSERT_TRUE(controller.setCapacity(-1, 10000));
+    controller.start();
+    
+    // No trip finishes within the test, so every call made is either pending
+    // or on a car
+    std::atomic<size_t> made{0};
+    std::thread caller([&controller, &made] {
+        for (int i = 0; i < 3000; i++) {
+            controller.addRequest(i % 18 + 2, 20, Direction::UP);
+            made++;
+        }
+    });
+    
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+    while (std::chrono::steady_clock::now() < deadline) {
+        size_t before = made.load();
+        ControllerSnapshot snapshot = controller.snapshot();
+        size_t seen = snapshot.pending.size();
+        for (const auto& car : snapshot.cars) {
+            seen += car.requests.size();
+        }
+        EXPECT_GE(seen, before);
+        if (seen < before) {
+            break;
+        }
+    }
+    caller.join();
+    controller.stop();
+}